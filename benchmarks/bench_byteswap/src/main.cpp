@@ -0,0 +1,77 @@
+// k13
+// Kyle J Burgess
+
+#include "bytes.h"
+#include "pod_vector.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+
+// Returns the throughput of f in GB/s
+template<class F>
+double throughput(size_t bytes, size_t repeats, F f)
+{
+    auto t0 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i != repeats; ++i)
+    {
+        f();
+    }
+    auto t1 = std::chrono::steady_clock::now();
+
+    return static_cast<double>(bytes * repeats) / std::chrono::duration<double, std::nano>(t1 - t0).count();
+}
+
+template<class T>
+void bench(const char* name, size_t n, size_t repeats)
+{
+    k13::pod_vector<T> src(n), dst(n);
+    for (size_t i = 0; i != n; ++i)
+    {
+        src[i] = static_cast<T>(i * 2654435761u);
+    }
+
+    // One element at a time, as before the simd kernels
+    double scalar = throughput(n * sizeof(T), repeats, [&]()
+    {
+        T* d = dst.data();
+        const T* s = src.data();
+
+        for (size_t i = 0; i != n; ++i)
+        {
+            d[i] = k13::byteswap(s[i]);
+        }
+
+        asm volatile("" : : "r"(d) : "memory");
+    });
+
+    double copy = throughput(n * sizeof(T), repeats, [&]()
+    {
+        k13::byteswap(dst.data(), src.data(), n);
+    });
+
+    double in_place = throughput(n * sizeof(T), repeats, [&]()
+    {
+        k13::byteswap(dst.data(), n);
+    });
+
+    std::cout << name << "\tscalar " << scalar << " GB/s\tbyteswap " << copy << " GB/s\tin place " << in_place << " GB/s\n";
+}
+
+int main(int argc, char** argv)
+{
+    size_t bytes = (argc > 1)
+        ? std::strtoull(argv[1], nullptr, 10)
+        : (64u << 20u);
+
+    size_t repeats = 10;
+
+    std::cout << bytes << " bytes\n";
+
+    bench<uint16_t>("uint16_t", bytes / 2u, repeats);
+    bench<uint32_t>("uint32_t", bytes / 4u, repeats);
+    bench<uint64_t>("uint64_t", bytes / 8u, repeats);
+
+    return 0;
+}
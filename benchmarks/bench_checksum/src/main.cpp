@@ -0,0 +1,80 @@
+// k13
+// Kyle J Burgess
+
+#include "checksum.h"
+#include "pod_vector.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+
+// Returns the throughput of f in GB/s
+template<class F>
+double throughput(size_t bytes, size_t repeats, F f)
+{
+    auto t0 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i != repeats; ++i)
+    {
+        f();
+    }
+    auto t1 = std::chrono::steady_clock::now();
+
+    return static_cast<double>(bytes * repeats) / std::chrono::duration<double, std::nano>(t1 - t0).count();
+}
+
+int main(int argc, char** argv)
+{
+    size_t bytes = (argc > 1)
+        ? std::strtoull(argv[1], nullptr, 10)
+        : (64u << 20u);
+
+    size_t repeats = 10;
+    size_t n = bytes / sizeof(uint64_t);
+
+    k13::pod_vector<uint64_t> src(n), dst(n);
+    for (size_t i = 0; i != n; ++i)
+    {
+        src[i] = i * 0x9e3779b97f4a7c15ull;
+    }
+
+    const auto* data = reinterpret_cast<const uint8_t*>(src.data());
+    volatile uint64_t sink = 0;
+
+    std::cout << bytes << " bytes\n";
+
+    std::cout << "crc32c table\t" << throughput(bytes, repeats, [&]()
+    {
+        sink = k13::impl_crc32c_table(0, data, bytes);
+    }) << " GB/s\n";
+
+#ifdef K13_CRC32C_DISPATCH
+    std::cout << "crc32c sse4.2\t" << throughput(bytes, repeats, [&]()
+    {
+        sink = k13::impl_crc32c_sse42(0, data, bytes);
+    }) << " GB/s\n";
+
+    std::cout << "crc32c pclmul\t" << throughput(bytes, repeats, [&]()
+    {
+        sink = k13::impl_crc32c_sse42_pclmul(0, data, bytes);
+    }) << " GB/s\n";
+#endif
+
+    std::cout << "hash64\t\t" << throughput(bytes, repeats, [&]()
+    {
+        sink = k13::hash64(data, bytes);
+    }) << " GB/s\n";
+
+    std::cout << "byteswap, crc32c\t" << throughput(bytes, repeats, [&]()
+    {
+        k13::byteswap(dst.data(), src.data(), n);
+        sink = k13::crc32c(dst.data(), bytes);
+    }) << " GB/s\n";
+
+    std::cout << "byteswap_crc32c\t\t" << throughput(bytes, repeats, [&]()
+    {
+        sink = k13::byteswap_crc32c(dst.data(), src.data(), n);
+    }) << " GB/s\n";
+
+    return 0;
+}
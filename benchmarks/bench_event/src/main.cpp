@@ -0,0 +1,166 @@
+// k13
+// Kyle J Burgess
+
+#include "event.h"
+#include "static_event.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct Listener
+{
+    size_t total = 0;
+
+    k13::callback_persistence on_event(int x, const std::string& s)
+    {
+        total += static_cast<size_t>(x) + s.size();
+        return k13::persist_callback;
+    }
+};
+
+size_t g_total = 0;
+
+k13::callback_persistence on_step(int x)
+{
+    g_total += static_cast<size_t>(x);
+    return k13::persist_callback;
+}
+
+// Returns the time per subscriber call of invoke in nanoseconds
+template<class Subscribe>
+double time_invoke(size_t subscribers, size_t invokes, Subscribe subscribe)
+{
+    k13::event<int, std::string> e;
+    std::vector<std::shared_ptr<Listener>> listeners;
+
+    for (size_t i = 0; i != subscribers; ++i)
+    {
+        listeners.push_back(std::make_shared<Listener>());
+        subscribe(e, listeners.back());
+    }
+
+    std::string s(64, 'k');
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i != invokes; ++i)
+    {
+        e.invoke(static_cast<int>(i), s);
+    }
+    auto t1 = std::chrono::steady_clock::now();
+
+    size_t total = 0;
+    for (const auto& l : listeners)
+    {
+        total += l->total;
+    }
+
+    // Keep the work observable
+    if (total == 0)
+    {
+        std::cout << "";
+    }
+
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / static_cast<double>(invokes * subscribers);
+}
+
+int main(int argc, char** argv)
+{
+    size_t calls = (argc > 1)
+        ? std::strtoull(argv[1], nullptr, 10)
+        : 10000000u;
+
+    std::cout << "ns per subscriber call, event<int, std::string>\n";
+    std::cout << "subscribers\tlambda\tshared_ptr member\tpointer member\n";
+
+    for (size_t n : { 1u, 4u, 16u, 64u, 256u, 1024u })
+    {
+        size_t invokes = (calls / n > 0) ? calls / n : 1;
+
+        double lambda = time_invoke(n, invokes, [](auto& e, const std::shared_ptr<Listener>& l)
+        {
+            Listener* p = l.get();
+            e.add_callback([p](int x, const std::string& s)
+            {
+                return p->on_event(x, s);
+            });
+        });
+
+        double shared = time_invoke(n, invokes, [](auto& e, const std::shared_ptr<Listener>& l)
+        {
+            e.add_callback(l, &Listener::on_event);
+        });
+
+        double pointer = time_invoke(n, invokes, [](auto& e, const std::shared_ptr<Listener>& l)
+        {
+            e.add_callback(l.get(), &Listener::on_event);
+        });
+
+        std::cout << n << "\t\t" << lambda << "\t" << shared << "\t\t\t" << pointer << "\n";
+    }
+
+    std::cout << "ns per invoke, forwarding chain to one subscriber\n";
+    std::cout << "depth\tns\n";
+
+    for (size_t depth : { 1u, 4u, 16u, 64u })
+    {
+        std::vector<std::shared_ptr<k13::event<int, std::string>>> chain;
+
+        for (size_t i = 0; i != depth + 1u; ++i)
+        {
+            chain.push_back(std::make_shared<k13::event<int, std::string>>());
+
+            if (i != 0)
+            {
+                chain[i - 1]->forward(chain[i]);
+            }
+        }
+
+        auto listener = std::make_shared<Listener>();
+        chain.back()->add_callback(listener.get(), &Listener::on_event);
+
+        std::string s(64, 'k');
+
+        auto t0 = std::chrono::steady_clock::now();
+        for (size_t i = 0; i != calls; ++i)
+        {
+            chain.front()->invoke(static_cast<int>(i), s);
+        }
+        auto t1 = std::chrono::steady_clock::now();
+
+        std::cout << depth << "\t" << std::chrono::duration<double, std::nano>(t1 - t0).count() / static_cast<double>(calls) << "\n";
+    }
+
+    std::cout << "ns per invoke, four handlers fixed at compile time\n";
+
+    {
+        k13::event<int> dynamic;
+        for (int i = 0; i != 4; ++i)
+        {
+            dynamic.add_callback(&on_step);
+        }
+
+        using h = k13::static_handler<&on_step>;
+        k13::static_event<h, h, h, h> fixed;
+
+        auto t0 = std::chrono::steady_clock::now();
+        for (size_t i = 0; i != calls; ++i)
+        {
+            dynamic.invoke(static_cast<int>(i));
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        for (size_t i = 0; i != calls; ++i)
+        {
+            fixed.invoke(static_cast<int>(i));
+        }
+        auto t2 = std::chrono::steady_clock::now();
+
+        std::cout << "event\t\t" << std::chrono::duration<double, std::nano>(t1 - t0).count() / static_cast<double>(calls) << "\n";
+        std::cout << "static_event\t" << std::chrono::duration<double, std::nano>(t2 - t1).count() / static_cast<double>(calls) << "\n";
+    }
+
+    return (g_total == 0) ? 1 : 0;
+}
@@ -0,0 +1,107 @@
+// k13
+// Kyle J Burgess
+
+#include "pod_sort.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <thread>
+
+struct Record
+{
+    uint64_t key;
+    uint32_t id;
+    float weight;
+};
+
+// Returns the time taken by f(copy of data) in milliseconds
+template<class T, class F>
+double time_sort(const k13::pod_vector<T>& data, F f)
+{
+    k13::pod_vector<T> v = data;
+
+    auto t0 = std::chrono::steady_clock::now();
+    f(v);
+    auto t1 = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::milli>(t1 - t0).count();
+}
+
+void print(const char* name, double ms, double baseline)
+{
+    std::cout << "  " << name << ": " << ms << " ms (" << (baseline / ms) << "x)\n";
+}
+
+int main(int argc, char** argv)
+{
+    size_t n = (argc > 1)
+        ? std::strtoull(argv[1], nullptr, 10)
+        : 10000000u;
+
+    size_t threads = std::thread::hardware_concurrency();
+    k13::thread_pool pool((threads > 0) ? threads : 1, std::chrono::milliseconds(1));
+
+    std::mt19937_64 rng(13);
+
+    std::cout << n << " elements, " << pool.size() << " threads\n";
+
+    // uint64_t
+    {
+        k13::pod_vector<uint64_t> data(n);
+        for (size_t i = 0; i != n; ++i)
+        {
+            data[i] = rng();
+        }
+
+        double base = time_sort(data, [](k13::pod_vector<uint64_t>& v) { std::sort(v.data(), v.data() + v.size()); });
+
+        std::cout << "uint64_t\n";
+        print("std::sort", base, base);
+        print("radix_sort", time_sort(data, [](k13::pod_vector<uint64_t>& v) { k13::radix_sort(v.data(), v.size()); }), base);
+        print("radix_sort (pool)", time_sort(data, [&](k13::pod_vector<uint64_t>& v) { k13::radix_sort(pool, v.data(), v.size()); }), base);
+        print("parallel_sort", time_sort(data, [&](k13::pod_vector<uint64_t>& v) { k13::parallel_sort(pool, v.data(), v.size()); }), base);
+    }
+
+    // double
+    {
+        k13::pod_vector<double> data(n);
+        std::normal_distribution<double> dist;
+        for (size_t i = 0; i != n; ++i)
+        {
+            data[i] = dist(rng);
+        }
+
+        double base = time_sort(data, [](k13::pod_vector<double>& v) { std::sort(v.data(), v.data() + v.size()); });
+
+        std::cout << "double\n";
+        print("std::sort", base, base);
+        print("radix_sort", time_sort(data, [](k13::pod_vector<double>& v) { k13::radix_sort(v.data(), v.size()); }), base);
+        print("radix_sort (pool)", time_sort(data, [&](k13::pod_vector<double>& v) { k13::radix_sort(pool, v.data(), v.size()); }), base);
+    }
+
+    // Record by key
+    {
+        k13::pod_vector<Record> data(n);
+        for (size_t i = 0; i != n; ++i)
+        {
+            data[i] = { rng(), static_cast<uint32_t>(i), 1.0f };
+        }
+
+        auto key = [](const Record& r) { return r.key; };
+        auto less = [](const Record& a, const Record& b) { return a.key < b.key; };
+
+        double base = time_sort(data, [&](k13::pod_vector<Record>& v) { std::sort(v.data(), v.data() + v.size(), less); });
+
+        std::cout << "Record\n";
+        print("std::sort", base, base);
+        print("radix_sort", time_sort(data, [&](k13::pod_vector<Record>& v) { k13::radix_sort(v.data(), v.size(), key); }), base);
+        print("radix_sort (pool)", time_sort(data, [&](k13::pod_vector<Record>& v) { k13::radix_sort(pool, v.data(), v.size(), key); }), base);
+        print("parallel_sort", time_sort(data, [&](k13::pod_vector<Record>& v) { k13::parallel_sort(pool, v.data(), v.size(), less); }), base);
+    }
+
+    return 0;
+}
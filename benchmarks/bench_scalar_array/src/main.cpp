@@ -0,0 +1,98 @@
+// k13
+// Kyle J Burgess
+
+#include "scalar_array.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+
+// Returns the elements per nanosecond of f
+template<class F>
+double throughput(size_t n, size_t repeats, F f)
+{
+    auto t0 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i != repeats; ++i)
+    {
+        f();
+    }
+    auto t1 = std::chrono::steady_clock::now();
+
+    return static_cast<double>(n * repeats) / std::chrono::duration<double, std::nano>(t1 - t0).count();
+}
+
+// Compares adding and comparing a column of n scalars against a pod_vector<scalar_t>
+// kind 0 is all integers, 1 is all reals, and 2 is a mix
+void bench(const char* name, size_t n, size_t repeats, int kind)
+{
+    k13::pod_vector<k13::scalar_t> a(n), b(n), c(n);
+
+    uint64_t state = 13;
+    for (size_t i = 0; i != n; ++i)
+    {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        auto x = static_cast<int64_t>(state >> 44u);
+
+        bool real = (kind == 1) || (kind == 2 && ((state >> 20u) & 1u));
+        a[i] = real ? k13::scalar_t(static_cast<double>(x) * 0.5) : k13::scalar_t(x);
+        b[i] = x + 1;
+    }
+
+    k13::scalar_array x(a.data(), n);
+    k13::scalar_array y(b.data(), n);
+    k13::scalar_array z;
+    k13::pod_vector<uint8_t> mask(n);
+
+    double vector_add = throughput(n, repeats, [&]()
+    {
+        for (size_t i = 0; i != n; ++i)
+        {
+            c[i] = a[i] + b[i];
+        }
+
+        asm volatile("" : : "r"(c.data()) : "memory");
+    });
+
+    double array_add = throughput(n, repeats, [&]()
+    {
+        z = x + y;
+    });
+
+    double vector_less = throughput(n, repeats, [&]()
+    {
+        for (size_t i = 0; i != n; ++i)
+        {
+            mask[i] = a[i] < b[i];
+        }
+
+        asm volatile("" : : "r"(mask.data()) : "memory");
+    });
+
+    double array_less = throughput(n, repeats, [&]()
+    {
+        mask = x < y;
+    });
+
+    std::cout << name
+        << "\tadd pod_vector " << vector_add << " /ns scalar_array " << array_add << " /ns"
+        << "\tless pod_vector " << vector_less << " /ns scalar_array " << array_less << " /ns\n";
+}
+
+int main(int argc, char** argv)
+{
+    size_t n = (argc > 1)
+        ? std::strtoull(argv[1], nullptr, 10)
+        : (1u << 20u);
+
+    size_t repeats = 20;
+
+    std::cout << n << " scalars, " << sizeof(k13::scalar_t) << " B per pod_vector element, "
+        << (8.0 + 1.0 / 8.0) << " B per scalar_array element\n";
+
+    bench("int", n, repeats, 0);
+    bench("real", n, repeats, 1);
+    bench("mixed", n, repeats, 2);
+
+    return 0;
+}
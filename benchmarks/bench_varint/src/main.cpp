@@ -0,0 +1,89 @@
+// k13
+// Kyle J Burgess
+
+#include "varint.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+
+// Returns the decoded values per nanosecond of f
+template<class F>
+double throughput(size_t n, size_t repeats, F f)
+{
+    auto t0 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i != repeats; ++i)
+    {
+        f();
+    }
+    auto t1 = std::chrono::steady_clock::now();
+
+    return static_cast<double>(n * repeats) / std::chrono::duration<double, std::nano>(t1 - t0).count();
+}
+
+template<uint32_t Bits>
+void bench(size_t n, size_t repeats)
+{
+    n -= n % k13::bitpack_block_size;
+
+    k13::pod_vector<uint32_t> values(n), decoded(n);
+
+    uint64_t state = 13;
+    for (size_t i = 0; i != n; ++i)
+    {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        values[i] = static_cast<uint32_t>(state >> 32u) & k13::impl_bitpack_mask<Bits>();
+    }
+
+    k13::pod_vector<uint8_t> varints;
+    k13::varint_append(varints, values.data(), n);
+
+    k13::pod_vector<uint8_t> packed;
+    k13::bitpack_append(packed, values.data(), n);
+
+    double varint = throughput(n, repeats, [&]()
+    {
+        k13::varint_decode(varints.data(), varints.size(), decoded.data(), n);
+    });
+
+    double scalar = throughput(n, repeats, [&]()
+    {
+        for (size_t i = 0; i != n; i += k13::bitpack_block_size)
+        {
+            k13::impl_bitunpack128_scalar<Bits>(packed.data() + (i / k13::bitpack_block_size) * (1u + k13::bitpack_bytes(Bits)) + 1u, decoded.data() + i);
+        }
+
+        asm volatile("" : : "r"(decoded.data()) : "memory");
+    });
+
+    double vector = throughput(n, repeats, [&]()
+    {
+        k13::bitpack_decode(packed.data(), packed.size(), decoded.data(), n);
+    });
+
+    std::cout << Bits << " bits"
+        << "\tvarint " << static_cast<double>(varints.size()) / static_cast<double>(n) << " B " << varint << " /ns"
+        << "\tbitpack " << static_cast<double>(packed.size()) / static_cast<double>(n) << " B"
+        << " scalar " << scalar << " /ns"
+        << " decode " << vector << " /ns\n";
+}
+
+int main(int argc, char** argv)
+{
+    size_t n = (argc > 1)
+        ? std::strtoull(argv[1], nullptr, 10)
+        : (1u << 22u);
+
+    size_t repeats = 10;
+
+    std::cout << n << " values, bytes per value and values per ns\n";
+
+    bench<4>(n, repeats);
+    bench<7>(n, repeats);
+    bench<12>(n, repeats);
+    bench<20>(n, repeats);
+    bench<32>(n, repeats);
+
+    return 0;
+}
@@ -0,0 +1,388 @@
+// k13
+// Kyle J Burgess
+
+#ifndef K13_ASYNC_EVENT_H
+#define K13_ASYNC_EVENT_H
+
+#include "event.h"
+#include "delegate.h"
+#include "pod_span.h"
+#include "thread_pool.h"
+
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace k13
+{
+    // Asynchronous Event
+    // invoke stores its arguments and returns, subscribers are called later on a thread pool
+    // Each subscriber receives invocations in the order they were made, one at a time,
+    // while different subscribers are called in parallel
+    // Batch subscribers receive every invocation queued since their last call as one span
+    template<class... Args>
+    class async_event
+    {
+    public:
+
+        static_assert(!std::disjunction<std::is_reference<Args>...>::value, "async_event arguments are stored, and cannot be references");
+
+        // Stored arguments of one invocation
+        using args_type = std::tuple<Args...>;
+
+        // Function & Lambda binding
+        using func = delegate<callback_persistence(const Args&...)>;
+
+        // Batched Function & Lambda binding
+        using batch_func = delegate<callback_persistence(pod_span<const args_type>)>;
+
+        // Constructor
+        // the thread pool must outlive the event
+        explicit async_event(thread_pool& pool)
+            : m_pool(pool)
+            , m_state(std::make_shared<impl_state>())
+        {}
+
+        // Copy Constructor
+        async_event(const async_event&) = delete;
+
+        // Copy-Assignment Operator
+        async_event& operator=(const async_event&) = delete;
+
+        // Destructor
+        // waits for queued invocations to be delivered, including deliveries
+        // to subscribers that were disconnected while they were running
+        ~async_event()
+        {
+            try
+            {
+                flush();
+            }
+            catch (...)
+            {}
+        }
+
+        // Queues an invocation with args for every subscriber, without waiting for them
+        // may be called from a subscriber, even when the pool runs deliveries inline
+        void invoke(Args... args)
+        {
+            auto message = std::make_shared<const args_type>(std::move(args)...);
+
+            // Post without holding the event lock, since the pool may deliver
+            // inline, and the subscriber may call back into this event
+            std::vector<std::shared_ptr<impl_mailbox>> mailboxes;
+
+            {
+                std::lock_guard<std::mutex> lock(m_state->mtx);
+                mailboxes = m_state->mailboxes;
+            }
+
+            bool removed = false;
+
+            for (const auto& mailbox : mailboxes)
+            {
+                removed = !impl_post(mailbox, message) || removed;
+            }
+
+            if (removed)
+            {
+                m_state->impl_drop_removed();
+            }
+        }
+
+        // Subscribe to the event with a function, lambda or std::function
+        event_connection add_callback(func func)
+        {
+            auto mailbox = std::make_shared<impl_mailbox>();
+            mailbox->callback = std::move(func);
+            return impl_add(std::move(mailbox));
+        }
+
+        // Subscribe to the event with a function that receives invocations in batches
+        event_connection add_batch_callback(batch_func func)
+        {
+            auto mailbox = std::make_shared<impl_mailbox>();
+            mailbox->batch_callback = std::move(func);
+            return impl_add(std::move(mailbox));
+        }
+
+        // Waits until every queued invocation has been delivered, and no delivery is running
+        // rethrows the first exception thrown by a subscriber
+        void flush()
+        {
+            std::vector<std::shared_ptr<impl_mailbox>> mailboxes;
+
+            {
+                std::unique_lock<std::mutex> lock(m_state->mtx);
+
+                m_state->cv.wait(lock, [&]()
+                {
+                    return m_state->deliveries == 0;
+                });
+
+                mailboxes = m_state->mailboxes;
+            }
+
+            for (auto& mailbox : mailboxes)
+            {
+                std::lock_guard<std::mutex> lock(mailbox->mtx);
+
+                if (mailbox->exception)
+                {
+                    std::exception_ptr e = std::move(mailbox->exception);
+                    mailbox->exception = nullptr;
+                    std::rethrow_exception(e);
+                }
+            }
+        }
+
+    protected:
+
+        // Queued invocations of one subscriber
+        struct impl_mailbox
+        {
+            std::mutex mtx;
+
+            func callback;
+            batch_func batch_callback;
+
+            // Invocations waiting for callback
+            std::vector<std::shared_ptr<const args_type>> messages;
+
+            // Invocations waiting for batch_callback
+            std::vector<args_type> batch;
+
+            // True while a delivery task is queued or running
+            bool scheduled = false;
+
+            // True once the subscriber is removed
+            bool removed = false;
+
+            std::exception_ptr exception;
+            uint64_t id = 0;
+        };
+
+        struct impl_state : impl_event_base
+        {
+            mutable std::mutex mtx;
+            std::vector<std::shared_ptr<impl_mailbox>> mailboxes;
+            uint64_t next_id = 0;
+
+            // Delivery tasks queued or running, of connected and disconnected subscribers
+            size_t deliveries = 0;
+            std::condition_variable cv;
+
+            // Drop subscribers that removed themselves
+            void impl_drop_removed()
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+
+                for (size_t i = 0; i != mailboxes.size();)
+                {
+                    bool removed;
+
+                    {
+                        std::lock_guard<std::mutex> mailbox_lock(mailboxes[i]->mtx);
+                        removed = mailboxes[i]->removed;
+                    }
+
+                    if (removed)
+                    {
+                        mailboxes[i] = std::move(mailboxes.back());
+                        mailboxes.pop_back();
+                        continue;
+                    }
+
+                    ++i;
+                }
+            }
+
+            void impl_disconnect(uint32_t slot, uint32_t generation) override
+            {
+                uint64_t id = (static_cast<uint64_t>(generation) << 32u) | slot;
+
+                std::lock_guard<std::mutex> lock(mtx);
+
+                for (size_t i = 0; i != mailboxes.size(); ++i)
+                {
+                    if (mailboxes[i]->id == id)
+                    {
+                        {
+                            std::lock_guard<std::mutex> mailbox_lock(mailboxes[i]->mtx);
+                            mailboxes[i]->removed = true;
+                            mailboxes[i]->messages.clear();
+                            mailboxes[i]->batch.clear();
+                        }
+
+                        mailboxes[i] = std::move(mailboxes.back());
+                        mailboxes.pop_back();
+                        return;
+                    }
+                }
+            }
+
+            bool impl_connected(uint32_t slot, uint32_t generation) const override
+            {
+                uint64_t id = (static_cast<uint64_t>(generation) << 32u) | slot;
+
+                std::lock_guard<std::mutex> lock(mtx);
+
+                for (const auto& mailbox : mailboxes)
+                {
+                    if (mailbox->id == id)
+                    {
+                        std::lock_guard<std::mutex> mailbox_lock(mailbox->mtx);
+                        return !mailbox->removed;
+                    }
+                }
+
+                return false;
+            }
+        };
+
+        thread_pool& m_pool;
+        std::shared_ptr<impl_state> m_state;
+
+        event_connection impl_add(std::shared_ptr<impl_mailbox> mailbox)
+        {
+            std::lock_guard<std::mutex> lock(m_state->mtx);
+
+            uint64_t id = m_state->next_id++;
+            mailbox->id = id;
+            m_state->mailboxes.push_back(std::move(mailbox));
+
+            return event_connection(m_state, static_cast<uint32_t>(id), static_cast<uint32_t>(id >> 32u));
+        }
+
+        // Queue a message for a subscriber, and schedule its delivery if needed
+        // returns false if the subscriber was removed
+        bool impl_post(const std::shared_ptr<impl_mailbox>& mailbox, const std::shared_ptr<const args_type>& message)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mailbox->mtx);
+
+                if (mailbox->removed)
+                {
+                    return false;
+                }
+
+                if (mailbox->batch_callback)
+                {
+                    mailbox->batch.push_back(*message);
+                }
+                else
+                {
+                    mailbox->messages.push_back(message);
+                }
+
+                if (mailbox->scheduled)
+                {
+                    return true;
+                }
+
+                mailbox->scheduled = true;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m_state->mtx);
+                ++m_state->deliveries;
+            }
+
+            thread_task task;
+            m_pool.run(task, [state = m_state, mailbox]()
+            {
+                impl_deliver(*state, *mailbox);
+            });
+
+            return true;
+        }
+
+        // Keep the first exception thrown by a subscriber, for flush()
+        static void impl_record_exception(impl_mailbox& mailbox)
+        {
+            std::lock_guard<std::mutex> lock(mailbox.mtx);
+
+            if (!mailbox.exception)
+            {
+                mailbox.exception = std::current_exception();
+            }
+        }
+
+        // Deliver queued messages until the mailbox is empty
+        static void impl_deliver(impl_state& state, impl_mailbox& mailbox)
+        {
+            std::vector<std::shared_ptr<const args_type>> messages;
+            std::vector<args_type> batch;
+
+            while (true)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mailbox.mtx);
+
+                    // Clearing scheduled while holding the lock that invoke posts under
+                    // means the next invoke schedules a new delivery
+                    if (mailbox.removed || (mailbox.messages.empty() && mailbox.batch.empty()))
+                    {
+                        mailbox.scheduled = false;
+                        break;
+                    }
+
+                    messages.swap(mailbox.messages);
+                    batch.swap(mailbox.batch);
+                }
+
+                callback_persistence r = persist_callback;
+
+                // A callback that throws keeps receiving the messages after it,
+                // flush() reports the exception
+                if (!batch.empty())
+                {
+                    try
+                    {
+                        r = mailbox.batch_callback(pod_span<const args_type>(batch.data(), batch.size()));
+                    }
+                    catch (...)
+                    {
+                        impl_record_exception(mailbox);
+                    }
+                }
+
+                for (size_t i = 0; i != messages.size() && r == persist_callback; ++i)
+                {
+                    try
+                    {
+                        r = std::apply(mailbox.callback, *messages[i]);
+                    }
+                    catch (...)
+                    {
+                        impl_record_exception(mailbox);
+                    }
+                }
+
+                messages.clear();
+                batch.clear();
+
+                if (r == remove_callback)
+                {
+                    std::lock_guard<std::mutex> lock(mailbox.mtx);
+                    mailbox.removed = true;
+                    mailbox.messages.clear();
+                    mailbox.batch.clear();
+                }
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(state.mtx);
+                --state.deliveries;
+            }
+
+            state.cv.notify_all();
+        }
+    };
+}
+
+#endif
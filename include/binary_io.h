@@ -0,0 +1,350 @@
+// k13
+// Kyle J Burgess
+
+#ifndef K13_BINARY_IO_H
+#define K13_BINARY_IO_H
+
+#include "bytes.h"
+#include "pod_span.h"
+#include "pod_vector.h"
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+namespace k13
+{
+    enum endian
+    {
+        little_endian,
+        big_endian,
+
+    #if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+        native_endian = big_endian,
+    #else
+        native_endian = little_endian,
+    #endif
+    };
+
+    // Converts x between native and E byte order
+    // a no-op at compile time when E is native
+    template<endian E, class T>
+    K13_INLINE_ATTRIBUTE K13_BYTESWAP_CONSTEXPR
+    T to_endian(T x)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "to_endian requires a trivially copyable type");
+
+        if constexpr (E == native_endian || sizeof(T) == 1)
+        {
+            return x;
+        }
+        else
+        {
+            return byteswap(x);
+        }
+    }
+
+    // Byteswap n T from src to dst, where neither needs to be aligned
+    template<class T>
+    void impl_byteswap_unaligned(uint8_t* dst, const uint8_t* src, size_t n)
+    {
+        size_t done = 0;
+
+        if constexpr (16u % sizeof(T) == 0)
+        {
+            done = impl_shuffle_bytes(dst, src, n * sizeof(T), impl_byteswap_mask<sizeof(T)>::value) / sizeof(T);
+        }
+
+        for (size_t i = done; i != n; ++i)
+        {
+            if constexpr (impl_byteswap_padded<T>::value)
+            {
+                impl_byteswap_bytes<sizeof(T)>(dst + i * sizeof(T), src + i * sizeof(T));
+            }
+            else
+            {
+                T x;
+                memcpy(&x, src + i * sizeof(T), sizeof(T));
+                x = byteswap(x);
+                memcpy(dst + i * sizeof(T), &x, sizeof(T));
+            }
+        }
+    }
+
+    // Binary Reader
+    // A cursor over a contiguous byte buffer, that reads typed values in a given byte order
+    // Reads only assert their bounds: check once per message with can_read or take,
+    // then read its fields without further checks
+    // The buffer must outlive the reader
+    class binary_reader
+    {
+    public:
+
+        // Constructor
+        binary_reader()
+            : m_data(nullptr)
+            , m_size(0)
+            , m_position(0)
+        {}
+
+        // Constructor
+        binary_reader(const uint8_t* data, size_t size)
+            : m_data(data)
+            , m_size(size)
+            , m_position(0)
+        {}
+
+        // Construct a reader over a span
+        binary_reader(pod_span<const uint8_t> span)
+            : binary_reader(span.data(), span.size())
+        {}
+
+        // Construct a reader over a pod_vector
+        binary_reader(const pod_vector<uint8_t>& v)
+            : binary_reader(v.data(), v.size())
+        {}
+
+        // True if n more bytes can be read
+        [[nodiscard]]
+        bool can_read(size_t n) const
+        {
+            return n <= m_size - m_position;
+        }
+
+        // Returns a reader over the next n bytes, and skips them
+        // the one bounds check for every read of a message
+        // throws std::runtime_error if fewer than n bytes remain
+        binary_reader take(size_t n)
+        {
+            if (!can_read(n))
+            {
+                throw std::runtime_error("binary_reader read past the end of the buffer");
+            }
+
+            binary_reader r(m_data + m_position, n);
+            m_position += n;
+            return r;
+        }
+
+        // Reads a T stored in E byte order
+        template<class T, endian E = native_endian>
+        T read()
+        {
+            assert(can_read(sizeof(T)));
+
+            T x;
+            memcpy(&x, m_data + m_position, sizeof(T));
+            m_position += sizeof(T);
+
+            return to_endian<E>(x);
+        }
+
+        // Reads n T stored in E byte order
+        template<class T, endian E = native_endian>
+        void read(T* dst, size_t n)
+        {
+            assert(can_read(n * sizeof(T)));
+
+            if constexpr (E == native_endian || sizeof(T) == 1)
+            {
+                memcpy(dst, m_data + m_position, n * sizeof(T));
+            }
+            else
+            {
+                impl_byteswap_unaligned<T>(reinterpret_cast<uint8_t*>(dst), m_data + m_position, n);
+            }
+
+            m_position += n * sizeof(T);
+        }
+
+        // Returns a view of the next T without copying it, and skips it
+        // T is read in native byte order, typically a packed struct of byte arrays
+        template<class T>
+        const T* view()
+        {
+            return view_array<T>(1).data();
+        }
+
+        // Returns a view of the next n T without copying them, and skips them
+        template<class T>
+        pod_span<const T> view_array(size_t n)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "binary_reader can only view trivially copyable types");
+
+            assert(can_read(n * sizeof(T)));
+            assert(reinterpret_cast<uintptr_t>(m_data + m_position) % alignof(T) == 0);
+
+            pod_span<const T> span(reinterpret_cast<const T*>(m_data + m_position), n);
+            m_position += n * sizeof(T);
+
+            return span;
+        }
+
+        // Skips n bytes
+        void skip(size_t n)
+        {
+            assert(can_read(n));
+            m_position += n;
+        }
+
+        // Returns the read position
+        [[nodiscard]]
+        size_t position() const
+        {
+            return m_position;
+        }
+
+        // Sets the read position
+        void seek(size_t position)
+        {
+            assert(position <= m_size);
+            m_position = position;
+        }
+
+        // Returns the number of bytes left
+        [[nodiscard]]
+        size_t remaining() const
+        {
+            return m_size - m_position;
+        }
+
+        // Returns the size of the buffer
+        [[nodiscard]]
+        size_t size() const
+        {
+            return m_size;
+        }
+
+        // Returns the bytes at the read position
+        [[nodiscard]]
+        const uint8_t* data() const
+        {
+            return m_data + m_position;
+        }
+
+    protected:
+
+        const uint8_t* m_data;
+        size_t m_size;
+        size_t m_position;
+    };
+
+    // Binary Writer
+    // A cursor over a contiguous byte buffer, that writes typed values in a given byte order
+    // Writes only assert their bounds: check once per message with can_write or take,
+    // or reserve the space for a message with append, then write its fields
+    // The buffer must outlive the writer
+    class binary_writer
+    {
+    public:
+
+        // Constructor
+        binary_writer()
+            : m_data(nullptr)
+            , m_size(0)
+            , m_position(0)
+        {}
+
+        // Constructor
+        binary_writer(uint8_t* data, size_t size)
+            : m_data(data)
+            , m_size(size)
+            , m_position(0)
+        {}
+
+        // Construct a writer over a span
+        binary_writer(pod_span<uint8_t> span)
+            : binary_writer(span.data(), span.size())
+        {}
+
+        // Returns a writer over n new bytes at the end of v
+        // v must not be resized while the writer is used
+        static binary_writer append(pod_vector<uint8_t>& v, size_t n)
+        {
+            size_t size = v.size();
+            v.resize(size + n);
+            return binary_writer(v.data() + size, n);
+        }
+
+        // True if n more bytes can be written
+        [[nodiscard]]
+        bool can_write(size_t n) const
+        {
+            return n <= m_size - m_position;
+        }
+
+        // Returns a writer over the next n bytes, and skips them
+        // throws std::runtime_error if fewer than n bytes remain
+        binary_writer take(size_t n)
+        {
+            if (!can_write(n))
+            {
+                throw std::runtime_error("binary_writer wrote past the end of the buffer");
+            }
+
+            binary_writer w(m_data + m_position, n);
+            m_position += n;
+            return w;
+        }
+
+        // Writes x as a T in E byte order
+        template<class T, endian E = native_endian>
+        void write(T x)
+        {
+            assert(can_write(sizeof(T)));
+
+            x = to_endian<E>(x);
+            memcpy(m_data + m_position, &x, sizeof(T));
+            m_position += sizeof(T);
+        }
+
+        // Writes n T in E byte order
+        template<class T, endian E = native_endian>
+        void write(const T* src, size_t n)
+        {
+            assert(can_write(n * sizeof(T)));
+
+            if constexpr (E == native_endian || sizeof(T) == 1)
+            {
+                memcpy(m_data + m_position, src, n * sizeof(T));
+            }
+            else
+            {
+                impl_byteswap_unaligned<T>(m_data + m_position, reinterpret_cast<const uint8_t*>(src), n);
+            }
+
+            m_position += n * sizeof(T);
+        }
+
+        // Returns the write position
+        [[nodiscard]]
+        size_t position() const
+        {
+            return m_position;
+        }
+
+        // Returns the number of bytes left
+        [[nodiscard]]
+        size_t remaining() const
+        {
+            return m_size - m_position;
+        }
+
+        // Returns the bytes at the write position
+        [[nodiscard]]
+        uint8_t* data() const
+        {
+            return m_data + m_position;
+        }
+
+    protected:
+
+        uint8_t* m_data;
+        size_t m_size;
+        size_t m_position;
+    };
+}
+
+#endif
@@ -6,6 +6,8 @@
 
 #include <cstring>
 #include <cstdint>
+#include <cstddef>
+#include <limits>
 #include <type_traits>
 
 // Check for gcc bswap support
@@ -14,12 +16,55 @@
 #define K13_GCC_BSWAP_SUPPORT
 #endif
 
+// Check for gcc popcount support
+#undef K13_GCC_POPCOUNT_SUPPORT
+#if defined(__GNUC__) || defined(__clang__)
+#define K13_GCC_POPCOUNT_SUPPORT
+#endif
+
 // Check for msc bswap support
 #undef K13_MSC_BSWAP_SUPPORT
 #ifdef _MSC_VER
 #define K13_MSC_BSWAP_SUPPORT
 #endif
 
+// Check for gcc 128-bit bswap support
+#undef K13_GCC_BSWAP128_SUPPORT
+#if defined(__GNUC__) && !defined(__clang__) && (__GNUC__ >= 11)
+#define K13_GCC_BSWAP128_SUPPORT
+#endif
+
+// Check for 128-bit integer support
+#undef K13_INT128_SUPPORT
+#ifdef __SIZEOF_INT128__
+#define K13_INT128_SUPPORT
+#endif
+
+// Check for bit cast support, which lets byteswap be constexpr
+#undef K13_BIT_CAST_SUPPORT
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_bit_cast)
+#define K13_BIT_CAST_SUPPORT
+#endif
+#elif defined(_MSC_VER) && (_MSC_VER >= 1927)
+#define K13_BIT_CAST_SUPPORT
+#endif
+
+// Constexpr byteswap, where bit casts and bswap builtins can be constant evaluated
+#undef K13_BYTESWAP_CONSTEXPR
+#if defined(K13_BIT_CAST_SUPPORT) && !defined(K13_MSC_BSWAP_SUPPORT)
+#define K13_BYTESWAP_CONSTEXPR constexpr
+#else
+#define K13_BYTESWAP_CONSTEXPR
+#endif
+
+// Check for x86 simd kernels with runtime dispatch
+#undef K13_X86_SIMD_DISPATCH
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define K13_X86_SIMD_DISPATCH
+#include <immintrin.h>
+#endif
+
 // Inline Expression
 #undef K13_INLINE_ATTRIBUTE
 #ifdef _MSC_VER
@@ -30,32 +75,76 @@
 
 namespace k13
 {
+    // Bytes of a trivially copyable object
+    template<size_t Size>
+    struct impl_bytes
+    {
+        uint8_t value[Size];
+    };
+
+    // Copies the bytes of x into a To of the same size
+    template<class To, class From>
+    K13_INLINE_ATTRIBUTE K13_BYTESWAP_CONSTEXPR
+    To impl_bit_cast(const From& x)
+    {
+        static_assert(sizeof(To) == sizeof(From), "bit cast requires types of the same size");
+
+    #ifdef K13_BIT_CAST_SUPPORT
+        return __builtin_bit_cast(To, x);
+    #else
+        To y;
+        memcpy(&y, &x, sizeof(To));
+        return y;
+    #endif
+    }
+
+    // True for types with padding bytes that a copy need not keep, which is x87 extended
+    // precision long double, 10 value bytes in a 12 or 16 byte object
+    // Reversed, its value bytes land in the padding, so it can only be swapped in memory
     template<class T>
+    struct impl_byteswap_padded
+    {
+        static constexpr bool value =
+            std::is_same<typename std::remove_cv<T>::type, long double>::value &&
+            (sizeof(long double) > 10u) &&
+            (std::numeric_limits<long double>::digits == 64);
+    };
+
+    // Reverses the Size bytes of src into dst, where dst may equal src
+    template<size_t Size>
     K13_INLINE_ATTRIBUTE
-    T byteswap(T x)
+    void impl_byteswap_bytes(uint8_t* dst, const uint8_t* src)
     {
-        if constexpr (!std::is_unsigned<T>::value)
+        for (size_t i = 0; i != Size / 2u; ++i)
         {
-            if constexpr (sizeof(T) == 2u)
-            {
-                auto r = byteswap(reinterpret_cast<uint16_t&>(x));
-                return reinterpret_cast<T&>(r);
-            }
-
-            if constexpr (sizeof(T) == 4u)
-            {
-                auto r = byteswap(reinterpret_cast<uint32_t&>(x));
-                return reinterpret_cast<T&>(r);
-            }
+            uint8_t a = src[i];
+            uint8_t b = src[Size - 1u - i];
+            dst[i] = b;
+            dst[Size - 1u - i] = a;
+        }
 
-            if constexpr (sizeof(T) == 8u)
-            {
-                auto r = byteswap(reinterpret_cast<uint64_t&>(x));
-                return reinterpret_cast<T&>(r);
-            }
+        if constexpr (Size % 2u != 0)
+        {
+            dst[Size / 2u] = src[Size / 2u];
         }
+    }
 
-        if constexpr (sizeof(T) == 8)
+    // Reverses the bytes of x
+    // 2, 4, 8 and 16 byte types use the bswap builtins, and any other size is reversed byte by byte
+    // constexpr where the compiler has a bit cast builtin
+    // Types with padding, such as x87 long double, are swapped only by the array overloads
+    template<class T>
+    K13_INLINE_ATTRIBUTE K13_BYTESWAP_CONSTEXPR
+    T byteswap(T x)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "byteswap requires a trivially copyable type");
+        static_assert(!impl_byteswap_padded<T>::value, "byteswap of a type with padding loses bytes, swap it in memory with byteswap(T*, n)");
+
+        if constexpr (sizeof(T) == 1)
+        {
+            return x;
+        }
+        else if constexpr (std::is_same<T, uint64_t>::value)
         {
         #if   defined K13_MSC_BSWAP_SUPPORT
             return _byteswap_uint64(x);
@@ -73,8 +162,7 @@ namespace k13
                 ( x >> 56);
         #endif
         }
-
-        if constexpr (sizeof(T) == 4)
+        else if constexpr (std::is_same<T, uint32_t>::value)
         {
         #if   defined K13_MSC_BSWAP_SUPPORT
             return _byteswap_ulong(x);
@@ -88,33 +176,377 @@ namespace k13
                 ( x >> 24);
         #endif
         }
-
-        if constexpr (sizeof(T) == 2)
+        else if constexpr (std::is_same<T, uint16_t>::value)
         {
         #if   defined K13_MSC_BSWAP_SUPPORT
             return _byteswap_ushort(x);
         #elif defined K13_GCC_BSWAP_SUPPORT
             return __builtin_bswap16(x);
         #else
-            return
+            return static_cast<uint16_t>(
                 ((x << 8) & 0xff00u) |
-                ( x >> 8);
+                ( x >> 8));
+        #endif
+        }
+    #ifdef K13_INT128_SUPPORT
+        else if constexpr (std::is_same<T, unsigned __int128>::value)
+        {
+        #ifdef K13_GCC_BSWAP128_SUPPORT
+            return __builtin_bswap128(x);
+        #else
+            return
+                (static_cast<unsigned __int128>(byteswap(static_cast<uint64_t>(x))) << 64) |
+                byteswap(static_cast<uint64_t>(x >> 64));
         #endif
         }
+    #endif
+        else if constexpr (sizeof(T) == 2)
+        {
+            return impl_bit_cast<T>(byteswap(impl_bit_cast<uint16_t>(x)));
+        }
+        else if constexpr (sizeof(T) == 4)
+        {
+            return impl_bit_cast<T>(byteswap(impl_bit_cast<uint32_t>(x)));
+        }
+        else if constexpr (sizeof(T) == 8)
+        {
+            return impl_bit_cast<T>(byteswap(impl_bit_cast<uint64_t>(x)));
+        }
+    #ifdef K13_INT128_SUPPORT
+        else if constexpr (sizeof(T) == 16)
+        {
+            return impl_bit_cast<T>(byteswap(impl_bit_cast<unsigned __int128>(x)));
+        }
+    #endif
+        else
+        {
+            auto bytes = impl_bit_cast<impl_bytes<sizeof(T)>>(x);
+
+            for (size_t i = 0; i != sizeof(T) / 2u; ++i)
+            {
+                uint8_t b = bytes.value[i];
+                bytes.value[i] = bytes.value[sizeof(T) - 1u - i];
+                bytes.value[sizeof(T) - 1u - i] = b;
+            }
+
+            return impl_bit_cast<T>(bytes);
+        }
+    }
+
+    // Number of set bits in x
+    // msc's __popcnt64 needs a cpu check, so it uses the bit count fallback
+    K13_INLINE_ATTRIBUTE constexpr
+    uint64_t impl_popcount(uint64_t x)
+    {
+    #ifdef K13_GCC_POPCOUNT_SUPPORT
+        return static_cast<uint64_t>(__builtin_popcountll(x));
+    #else
+        x = x - ((x >> 1) & 0x5555555555555555ull);
+        x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+        x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0full;
+        return (x * 0x0101010101010101ull) >> 56;
+    #endif
+    }
+
+    // Byte shuffle kernels
+    // Each permutes the bytes of every 16 byte block of src into dst by the same mask,
+    // where dst byte i = src byte mask[i] of its block, and returns the number of bytes done
+    // (a multiple of 16), leaving the tail for the caller
+    // Loads and stores are unaligned, and dst may equal src
+
+    using impl_shuffle_func = size_t(*)(uint8_t* dst, const uint8_t* src, size_t bytes, const uint8_t* mask);
+
+#ifdef K13_X86_SIMD_DISPATCH
+    __attribute__((target("ssse3")))
+    inline size_t impl_shuffle_bytes_ssse3(uint8_t* dst, const uint8_t* src, size_t bytes, const uint8_t* mask)
+    {
+        const __m128i m = _mm_loadu_si128(reinterpret_cast<const __m128i*>(mask));
+
+        size_t i = 0;
+        for (; i + 64u <= bytes; i += 64u)
+        {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 16u));
+            __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 32u));
+            __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 48u));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_shuffle_epi8(a, m));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 16u), _mm_shuffle_epi8(b, m));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 32u), _mm_shuffle_epi8(c, m));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 48u), _mm_shuffle_epi8(d, m));
+        }
+
+        for (; i + 16u <= bytes; i += 16u)
+        {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_shuffle_epi8(a, m));
+        }
 
-        return x;
+        return i;
     }
 
+    __attribute__((target("avx2")))
+    inline size_t impl_shuffle_bytes_avx2(uint8_t* dst, const uint8_t* src, size_t bytes, const uint8_t* mask)
+    {
+        // vpshufb shuffles within each 16 byte lane, so the mask is repeated per lane
+        const __m256i m = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(mask)));
+
+        size_t i = 0;
+        for (; i + 128u <= bytes; i += 128u)
+        {
+            __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+            __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 32u));
+            __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 64u));
+            __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 96u));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_shuffle_epi8(a, m));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i + 32u), _mm256_shuffle_epi8(b, m));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i + 64u), _mm256_shuffle_epi8(c, m));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i + 96u), _mm256_shuffle_epi8(d, m));
+        }
+
+        for (; i + 32u <= bytes; i += 32u)
+        {
+            __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_shuffle_epi8(a, m));
+        }
+
+        if (i + 16u <= bytes)
+        {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_shuffle_epi8(a, _mm256_castsi256_si128(m)));
+            i += 16u;
+        }
+
+        return i;
+    }
+
+    __attribute__((target("avx512f,avx512bw")))
+    inline size_t impl_shuffle_bytes_avx512(uint8_t* dst, const uint8_t* src, size_t bytes, const uint8_t* mask)
+    {
+        const __m512i m = _mm512_maskz_broadcast_i32x4(0xffff, _mm_loadu_si128(reinterpret_cast<const __m128i*>(mask)));
+
+        size_t i = 0;
+        for (; i + 256u <= bytes; i += 256u)
+        {
+            __m512i a = _mm512_loadu_si512(src + i);
+            __m512i b = _mm512_loadu_si512(src + i + 64u);
+            __m512i c = _mm512_loadu_si512(src + i + 128u);
+            __m512i d = _mm512_loadu_si512(src + i + 192u);
+            _mm512_storeu_si512(dst + i, _mm512_shuffle_epi8(a, m));
+            _mm512_storeu_si512(dst + i + 64u, _mm512_shuffle_epi8(b, m));
+            _mm512_storeu_si512(dst + i + 128u, _mm512_shuffle_epi8(c, m));
+            _mm512_storeu_si512(dst + i + 192u, _mm512_shuffle_epi8(d, m));
+        }
+
+        for (; i + 64u <= bytes; i += 64u)
+        {
+            __m512i a = _mm512_loadu_si512(src + i);
+            _mm512_storeu_si512(dst + i, _mm512_shuffle_epi8(a, m));
+        }
+
+        // Finish whole 16 byte blocks with one masked load and store
+        size_t tail = (bytes - i) & ~size_t(15);
+        if (tail != 0)
+        {
+            __mmask64 k = (tail == 64u) ? ~__mmask64(0) : ((__mmask64(1) << tail) - 1u);
+            __m512i a = _mm512_maskz_loadu_epi8(k, src + i);
+            _mm512_mask_storeu_epi8(dst + i, k, _mm512_shuffle_epi8(a, m));
+            i += tail;
+        }
+
+        return i;
+    }
+
+    // Returns the widest shuffle kernel this cpu supports, or nullptr
+    inline impl_shuffle_func impl_select_shuffle_bytes()
+    {
+        __builtin_cpu_init();
+
+        if (__builtin_cpu_supports("avx512bw"))
+        {
+            return &impl_shuffle_bytes_avx512;
+        }
+
+        if (__builtin_cpu_supports("avx2"))
+        {
+            return &impl_shuffle_bytes_avx2;
+        }
+
+        if (__builtin_cpu_supports("ssse3"))
+        {
+            return &impl_shuffle_bytes_ssse3;
+        }
+
+        return nullptr;
+    }
+#endif
+
+    // Shuffle the bytes of every 16 byte block of src into dst with the fastest kernel available
+    // returns the number of bytes done, which is 0 without simd support
+    inline size_t impl_shuffle_bytes(
+        [[maybe_unused]] uint8_t* dst,
+        [[maybe_unused]] const uint8_t* src,
+        [[maybe_unused]] size_t bytes,
+        [[maybe_unused]] const uint8_t* mask)
+    {
+    #ifdef K13_X86_SIMD_DISPATCH
+        static const impl_shuffle_func kernel = impl_select_shuffle_bytes();
+
+        if (kernel != nullptr)
+        {
+            return kernel(dst, src, bytes, mask);
+        }
+    #endif
+
+        return 0;
+    }
+
+    // Periodic byte shuffle kernels
+    // Each permutes 16 byte block k of src into dst by mask k % Count, for whole periods
+    // of Count blocks, and returns the number of bytes done (a multiple of 16 * Count)
+    // masks holds two periods of masks, 32 * Count bytes, so 32 byte steps have one mask each
+    // Loads and stores are unaligned, and dst may equal src
+
+    using impl_shuffle_periodic_func = size_t(*)(uint8_t* dst, const uint8_t* src, size_t bytes, const uint8_t* masks);
+
+#ifdef K13_X86_SIMD_DISPATCH
+    template<size_t Count>
+    __attribute__((target("ssse3")))
+    inline size_t impl_shuffle_periodic_ssse3(uint8_t* dst, const uint8_t* src, size_t bytes, const uint8_t* masks)
+    {
+        constexpr size_t period = Count * 16u;
+
+        size_t i = 0;
+        for (; i + period <= bytes; i += period)
+        {
+            for (size_t k = 0; k != period; k += 16u)
+            {
+                __m128i m = _mm_loadu_si128(reinterpret_cast<const __m128i*>(masks + k));
+                __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + k));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + k), _mm_shuffle_epi8(a, m));
+            }
+        }
+
+        return i;
+    }
+
+    template<size_t Count>
+    __attribute__((target("avx2")))
+    inline size_t impl_shuffle_periodic_avx2(uint8_t* dst, const uint8_t* src, size_t bytes, const uint8_t* masks)
+    {
+        constexpr size_t period = Count * 16u;
+
+        size_t i = 0;
+        for (; i + 2u * period <= bytes; i += 2u * period)
+        {
+            for (size_t k = 0; k != 2u * period; k += 32u)
+            {
+                __m256i m = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(masks + k));
+                __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + k));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i + k), _mm256_shuffle_epi8(a, m));
+            }
+        }
+
+        if (i + period <= bytes)
+        {
+            for (size_t k = 0; k != period; k += 16u)
+            {
+                __m128i m = _mm_loadu_si128(reinterpret_cast<const __m128i*>(masks + k));
+                __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + k));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + k), _mm_shuffle_epi8(a, m));
+            }
+
+            i += period;
+        }
+
+        return i;
+    }
+
+    // Returns the widest periodic shuffle kernel this cpu supports, or nullptr
+    template<size_t Count>
+    inline impl_shuffle_periodic_func impl_select_shuffle_periodic()
+    {
+        __builtin_cpu_init();
+
+        if (__builtin_cpu_supports("avx2"))
+        {
+            return &impl_shuffle_periodic_avx2<Count>;
+        }
+
+        if (__builtin_cpu_supports("ssse3"))
+        {
+            return &impl_shuffle_periodic_ssse3<Count>;
+        }
+
+        return nullptr;
+    }
+#endif
+
+    // Shuffle each 16 byte block of src into dst by its mask in a period of Count masks
+    // returns the number of bytes done, which is 0 without simd support
+    template<size_t Count>
+    inline size_t impl_shuffle_periodic(
+        [[maybe_unused]] uint8_t* dst,
+        [[maybe_unused]] const uint8_t* src,
+        [[maybe_unused]] size_t bytes,
+        [[maybe_unused]] const uint8_t* masks)
+    {
+    #ifdef K13_X86_SIMD_DISPATCH
+        static const impl_shuffle_periodic_func kernel = impl_select_shuffle_periodic<Count>();
+
+        if (kernel != nullptr)
+        {
+            return kernel(dst, src, bytes, masks);
+        }
+    #endif
+
+        return 0;
+    }
+
+    // Shuffle mask that reverses each Size byte element of a 16 byte block
+    template<size_t Size>
+    struct impl_byteswap_mask
+    {
+        static_assert(16u % Size == 0, "byteswap mask element size must divide 16");
+
+        static constexpr uint8_t impl_at(size_t i)
+        {
+            return static_cast<uint8_t>((i / Size) * Size + (Size - 1u - i % Size));
+        }
+
+        static constexpr uint8_t value[16] =
+        {
+            impl_at(0),  impl_at(1),  impl_at(2),  impl_at(3),
+            impl_at(4),  impl_at(5),  impl_at(6),  impl_at(7),
+            impl_at(8),  impl_at(9),  impl_at(10), impl_at(11),
+            impl_at(12), impl_at(13), impl_at(14), impl_at(15),
+        };
+    };
+
     template<class T>
     void byteswap(T* x, size_t n)
     {
         if constexpr (sizeof(T) != 1)
         {
+            if constexpr (16u % sizeof(T) == 0)
+            {
+                auto bytes = reinterpret_cast<uint8_t*>(x);
+                size_t done = impl_shuffle_bytes(bytes, bytes, n * sizeof(T), impl_byteswap_mask<sizeof(T)>::value);
+                x += done / sizeof(T);
+                n -= done / sizeof(T);
+            }
+
             T* end = x + n;
 
             for (; x != end; ++x)
             {
-                *x = byteswap(*x);
+                if constexpr (impl_byteswap_padded<T>::value)
+                {
+                    impl_byteswap_bytes<sizeof(T)>(reinterpret_cast<uint8_t*>(x), reinterpret_cast<const uint8_t*>(x));
+                }
+                else
+                {
+                    *x = byteswap(*x);
+                }
             }
         }
     }
@@ -128,11 +560,32 @@ namespace k13
         }
         else
         {
+            if constexpr (16u % sizeof(T) == 0)
+            {
+                size_t done = impl_shuffle_bytes(
+                    reinterpret_cast<uint8_t*>(dst),
+                    reinterpret_cast<const uint8_t*>(src),
+                    n * sizeof(T),
+                    impl_byteswap_mask<sizeof(T)>::value);
+
+                dst += done / sizeof(T);
+                src += done / sizeof(T);
+                n -= done / sizeof(T);
+            }
+
             T* end = dst + n;
 
             for (; dst != end; ++dst)
             {
-                *dst = byteswap(*src);
+                if constexpr (impl_byteswap_padded<T>::value)
+                {
+                    impl_byteswap_bytes<sizeof(T)>(reinterpret_cast<uint8_t*>(dst), reinterpret_cast<const uint8_t*>(src));
+                }
+                else
+                {
+                    *dst = byteswap(*src);
+                }
+
                 ++src;
             }
         }
@@ -0,0 +1,32 @@
+// k13
+// Kyle J Burgess
+
+#ifndef K13_BYTESWAP_FILE_H
+#define K13_BYTESWAP_FILE_H
+
+#include "thread_pool.h"
+
+#include <cstdint>
+#include <string>
+
+namespace k13
+{
+    // Byteswap every element_size byte element of the file at src_path, writing the result to dst_path
+    // The file is streamed through a ring of block_count blocks of block_size bytes,
+    // so memory use is bounded by their total regardless of the file size:
+    // the calling thread reads ahead, the pool swaps each block, and a writer thread
+    // writes the swapped blocks back in order, so reads and writes overlap
+    // element_size must be 1, 2, 4 or 8, and src_path and dst_path must be different files
+    // returns the number of bytes converted
+    // throws std::runtime_error on invalid arguments, I/O errors, a file size
+    // that is not a multiple of element_size, or a dst_path naming the source file
+    uint64_t byteswap_file(
+        const std::string& src_path,
+        const std::string& dst_path,
+        size_t element_size,
+        thread_pool& pool,
+        size_t block_size = size_t(1) << 22u,
+        size_t block_count = 4);
+}
+
+#endif
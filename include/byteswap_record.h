@@ -0,0 +1,340 @@
+// k13
+// Kyle J Burgess
+
+#ifndef K13_BYTESWAP_RECORD_H
+#define K13_BYTESWAP_RECORD_H
+
+#include "bytes.h"
+#include "pod_vector.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <numeric>
+#include <tuple>
+#include <type_traits>
+
+// Declares the fields of a record type T, as member pointers
+// must be used at global scope, for example
+// K13_RECORD_FIELDS(Packet, &Packet::id, &Packet::position, &Packet::flags)
+#define K13_RECORD_FIELDS(T, ...)                                       \
+    namespace k13                                                       \
+    {                                                                   \
+        template<>                                                      \
+        struct record_fields<T>                                         \
+        {                                                               \
+            static constexpr auto value = std::make_tuple(__VA_ARGS__); \
+        };                                                              \
+    }
+
+namespace k13
+{
+    // Fields of a record type, specialized with K13_RECORD_FIELDS
+    template<class T>
+    struct record_fields;
+
+    // True if T has declared record fields
+    template<class T, class = void>
+    struct is_record : std::false_type
+    {};
+
+    template<class T>
+    struct is_record<T, std::void_t<decltype(record_fields<T>::value)>> : std::true_type
+    {};
+
+    template<class T>
+    void byteswap_record(T& r);
+
+    // Byteswap one field, which may be a scalar, an array or a nested record
+    template<class F>
+    K13_INLINE_ATTRIBUTE
+    void impl_byteswap_field(F& f)
+    {
+        if constexpr (std::is_array<F>::value)
+        {
+            for (auto& e : f)
+            {
+                impl_byteswap_field(e);
+            }
+        }
+        else if constexpr (is_record<F>::value)
+        {
+            byteswap_record(f);
+        }
+        else if constexpr (impl_byteswap_padded<F>::value)
+        {
+            auto bytes = reinterpret_cast<uint8_t*>(&f);
+            impl_byteswap_bytes<sizeof(F)>(bytes, bytes);
+        }
+        else
+        {
+            f = byteswap(f);
+        }
+    }
+
+    // Byteswap every declared field of a record
+    template<class T>
+    void byteswap_record(T& r)
+    {
+        static_assert(is_record<T>::value, "byteswap_record requires K13_RECORD_FIELDS for the type");
+
+        std::apply([&r](auto... fields)
+        {
+            (impl_byteswap_field(r.*fields), ...);
+        }, record_fields<T>::value);
+    }
+
+    // Byte offset of a field in a record, r is only used for its address
+    template<class T, class M>
+    size_t impl_field_offset(const T& r, M field)
+    {
+        return static_cast<size_t>(reinterpret_cast<const uint8_t*>(&(r.*field)) - reinterpret_cast<const uint8_t*>(&r));
+    }
+
+    // A byte range of a record that is reversed as a whole
+    struct impl_record_span
+    {
+        uint32_t offset;
+        uint32_t size;
+    };
+
+    // Byte permutation of a record type, and how its arrays can be swapped in bulk
+    // The permutation is found from the offsets and sizes of the scalar fields, so
+    // no field ever holds bytes that are not a value of its type
+    template<class T>
+    struct impl_record_layout
+    {
+        static constexpr size_t size = sizeof(T);
+
+        // Records repeat their byte pattern every period bytes, a whole number of 16 byte blocks
+        // records larger than 256 bytes have no masks, as their period would be too long
+        static constexpr size_t period = (size <= 256)
+            ? (size * 16u / std::gcd(size, size_t(16)))
+            : 16u;
+
+        // If the fields tile every byte of the record into groups of width bytes,
+        // an array of records is swapped as an array of width byte integers (0 if not)
+        size_t width = 0;
+
+        // One shuffle mask for each 16 byte block of a period, which reverses the
+        // fields inside the block and keeps every other byte where it is,
+        // repeated for a second period as the periodic shuffle kernels expect
+        bool has_masks = false;
+        uint8_t masks[2u * period] = {};
+
+        // Fields of one period that cross a 16 byte block, reversed after the masks
+        pod_vector<impl_record_span> crossing;
+
+        static const impl_record_layout& get()
+        {
+            static const impl_record_layout layout;
+            return layout;
+        }
+
+        impl_record_layout()
+        {
+            // Scalar fields, bytes outside of them are left as they are
+            pod_vector<impl_record_span> fields;
+            impl_add_record<T>(fields, 0);
+
+            for (size_t w : { 8u, 4u, 2u })
+            {
+                if (size % w == 0 && impl_is_uniform(fields, w))
+                {
+                    width = w;
+                    break;
+                }
+            }
+
+            if constexpr (size <= 256)
+            {
+                has_masks = true;
+
+                for (size_t i = 0; i != 2u * period; ++i)
+                {
+                    masks[i] = static_cast<uint8_t>(i % 16u);
+                }
+
+                for (size_t r = 0; r != period / size; ++r)
+                {
+                    for (size_t j = 0; j != fields.size(); ++j)
+                    {
+                        const impl_record_span& f = fields[j];
+                        size_t first = r * size + f.offset;
+                        size_t last = first + f.size - 1u;
+
+                        if (first / 16u != last / 16u)
+                        {
+                            crossing.push_back({ static_cast<uint32_t>(first), f.size });
+                            continue;
+                        }
+
+                        for (size_t i = first; i <= last; ++i)
+                        {
+                            masks[i] = static_cast<uint8_t>((first + last - i) % 16u);
+                            masks[i + period] = masks[i];
+                        }
+                    }
+                }
+            }
+        }
+
+        // Add the scalar fields of a record of type R at offset
+        template<class R>
+        static void impl_add_record(pod_vector<impl_record_span>& fields, size_t offset)
+        {
+            static_assert(std::is_trivially_copyable<R>::value, "record fields must be trivially copyable");
+
+            // Never read, only used for the addresses of its fields
+            alignas(R) uint8_t storage[sizeof(R)];
+            const R& r = *reinterpret_cast<const R*>(storage);
+
+            std::apply([&](auto... members)
+            {
+                (impl_add_field<typename std::remove_reference<decltype(r.*members)>::type>(
+                    fields, offset + impl_field_offset(r, members)), ...);
+            }, record_fields<R>::value);
+        }
+
+        // Add a field of type F at offset, which may be a scalar, an array or a nested record
+        template<class F>
+        static void impl_add_field(pod_vector<impl_record_span>& fields, size_t offset)
+        {
+            using U = typename std::remove_cv<F>::type;
+
+            if constexpr (std::is_array<U>::value)
+            {
+                using E = typename std::remove_extent<U>::type;
+
+                for (size_t i = 0; i != std::extent<U>::value; ++i)
+                {
+                    impl_add_field<E>(fields, offset + i * sizeof(E));
+                }
+            }
+            else if constexpr (is_record<U>::value)
+            {
+                impl_add_record<U>(fields, offset);
+            }
+            else
+            {
+                fields.push_back({ static_cast<uint32_t>(offset), static_cast<uint32_t>(sizeof(U)) });
+            }
+        }
+
+        // True if every field is one width byte group, aligned to width, and the fields
+        // cover every byte of the record, which they do when their sizes add up to it
+        static bool impl_is_uniform(const pod_vector<impl_record_span>& fields, size_t w)
+        {
+            size_t covered = 0;
+
+            for (size_t i = 0; i != fields.size(); ++i)
+            {
+                if (fields[i].offset % w != 0 || fields[i].size != w)
+                {
+                    return false;
+                }
+
+                covered += fields[i].size;
+            }
+
+            return covered == size;
+        }
+    };
+
+    // Byteswap bytes as an array of U, which need not be aligned
+    template<class U>
+    void impl_byteswap_groups(uint8_t* bytes, size_t size)
+    {
+        size_t done = impl_shuffle_bytes(bytes, bytes, size, impl_byteswap_mask<sizeof(U)>::value);
+
+        for (; done != size; done += sizeof(U))
+        {
+            U u;
+            memcpy(&u, bytes + done, sizeof(U));
+            u = byteswap(u);
+            memcpy(bytes + done, &u, sizeof(U));
+        }
+    }
+
+    // Byteswap an array of n records
+    // Records whose fields tile into groups of one width are swapped as one integer array,
+    // other records up to 256 bytes with one shuffle mask per 16 byte block of their repeating pattern,
+    // finishing fields that cross a block and the last partial pattern one at a time
+    template<class T>
+    void byteswap_records(T* x, size_t n)
+    {
+        static_assert(is_record<T>::value, "byteswap_records requires K13_RECORD_FIELDS for the type");
+        static_assert(std::is_trivially_copyable<T>::value, "byteswap_records requires a trivially copyable type");
+
+        using layout_type = impl_record_layout<T>;
+
+        const auto& layout = layout_type::get();
+        auto bytes = reinterpret_cast<uint8_t*>(x);
+
+        switch (layout.width)
+        {
+            case 8:
+                impl_byteswap_groups<uint64_t>(bytes, n * sizeof(T));
+                return;
+            case 4:
+                impl_byteswap_groups<uint32_t>(bytes, n * sizeof(T));
+                return;
+            case 2:
+                impl_byteswap_groups<uint16_t>(bytes, n * sizeof(T));
+                return;
+            default:
+                break;
+        }
+
+        size_t done = 0;
+
+        if (layout.has_masks)
+        {
+            constexpr size_t period = layout_type::period;
+
+            done = (period == 16u)
+                ? impl_shuffle_bytes(bytes, bytes, n * sizeof(T), layout.masks)
+                : impl_shuffle_periodic<period / 16u>(bytes, bytes, n * sizeof(T), layout.masks);
+
+            done -= done % period;
+
+            for (size_t p = 0; p != done; p += period)
+            {
+                for (size_t j = 0; j != layout.crossing.size(); ++j)
+                {
+                    uint8_t* field = bytes + p + layout.crossing[j].offset;
+                    std::reverse(field, field + layout.crossing[j].size);
+                }
+            }
+
+            done /= sizeof(T);
+        }
+
+        for (size_t i = done; i != n; ++i)
+        {
+            byteswap_record(x[i]);
+        }
+    }
+
+    // Byteswap an array of n records from src to dst
+    template<class T>
+    void byteswap_records(T* dst, const T* src, size_t n)
+    {
+        if (dst != src)
+        {
+            memcpy(dst, src, n * sizeof(T));
+        }
+
+        byteswap_records(dst, n);
+    }
+
+    // Byteswap every record in a pod_vector
+    template<class T>
+    void byteswap_records(pod_vector<T>& v)
+    {
+        byteswap_records(v.data(), v.size());
+    }
+}
+
+#endif
@@ -0,0 +1,337 @@
+// k13
+// Kyle J Burgess
+
+#ifndef K13_CHECKSUM_H
+#define K13_CHECKSUM_H
+
+#include "binary_io.h"
+#include "bytes.h"
+
+#include <cstdint>
+#include <cstring>
+
+// Check for x86-64 crc32 kernels with runtime dispatch
+#undef K13_CRC32C_DISPATCH
+#if defined(K13_X86_SIMD_DISPATCH) && defined(__x86_64__)
+#define K13_CRC32C_DISPATCH
+#endif
+
+namespace k13
+{
+    // CRC-32C (Castagnoli) polynomial, bit reflected
+    constexpr uint32_t impl_crc32c_polynomial = 0x82f63b78u;
+
+    // Slicing-by-8 lookup tables
+    // value[0] is the byte at a time table, and value[k] advances it by k more zero bytes
+    struct impl_crc32c_tables
+    {
+        uint32_t value[8][256];
+
+        constexpr impl_crc32c_tables()
+            : value()
+        {
+            for (uint32_t i = 0; i != 256; ++i)
+            {
+                uint32_t crc = i;
+
+                for (size_t bit = 0; bit != 8; ++bit)
+                {
+                    crc = (crc & 1u) ? ((crc >> 1u) ^ impl_crc32c_polynomial) : (crc >> 1u);
+                }
+
+                value[0][i] = crc;
+            }
+
+            for (size_t k = 1; k != 8; ++k)
+            {
+                for (size_t i = 0; i != 256; ++i)
+                {
+                    uint32_t crc = value[k - 1][i];
+                    value[k][i] = (crc >> 8u) ^ value[0][crc & 0xffu];
+                }
+            }
+        }
+    };
+
+    inline constexpr impl_crc32c_tables impl_crc32c_table_values;
+
+    // Returns x^e modulo the polynomial, bit reflected
+    constexpr uint32_t impl_crc32c_xpow(size_t e)
+    {
+        uint32_t v = 0x80000000u;
+
+        for (size_t i = 0; i != e; ++i)
+        {
+            v = (v & 1u) ? ((v >> 1u) ^ impl_crc32c_polynomial) : (v >> 1u);
+        }
+
+        return v;
+    }
+
+    // CRC-32C kernels
+    // Each continues the raw crc register over size bytes, without the initial and final inversion
+
+    using impl_crc32c_func = uint32_t(*)(uint32_t crc, const uint8_t* data, size_t size);
+
+    // Little endian 32-bit load
+    K13_INLINE_ATTRIBUTE
+    uint32_t impl_load_le32(const uint8_t* p)
+    {
+        uint32_t x;
+        memcpy(&x, p, 4);
+        return to_endian<little_endian>(x);
+    }
+
+    // Little endian 64-bit load
+    K13_INLINE_ATTRIBUTE
+    uint64_t impl_load_le64(const uint8_t* p)
+    {
+        uint64_t x;
+        memcpy(&x, p, 8);
+        return to_endian<little_endian>(x);
+    }
+
+    // Portable kernel, 8 bytes per step
+    inline uint32_t impl_crc32c_table(uint32_t crc, const uint8_t* data, size_t size)
+    {
+        const auto& t = impl_crc32c_table_values.value;
+
+        for (; size >= 8u; size -= 8u, data += 8u)
+        {
+            uint32_t lo = crc ^ impl_load_le32(data);
+            uint32_t hi = impl_load_le32(data + 4u);
+
+            crc =
+                t[7][lo & 0xffu] ^ t[6][(lo >> 8u) & 0xffu] ^ t[5][(lo >> 16u) & 0xffu] ^ t[4][lo >> 24u] ^
+                t[3][hi & 0xffu] ^ t[2][(hi >> 8u) & 0xffu] ^ t[1][(hi >> 16u) & 0xffu] ^ t[0][hi >> 24u];
+        }
+
+        for (; size != 0; --size, ++data)
+        {
+            crc = (crc >> 8u) ^ t[0][(crc ^ *data) & 0xffu];
+        }
+
+        return crc;
+    }
+
+#ifdef K13_CRC32C_DISPATCH
+    // SSE4.2 kernel, one crc32 instruction per 8 bytes
+    __attribute__((target("sse4.2")))
+    inline uint32_t impl_crc32c_sse42(uint32_t crc, const uint8_t* data, size_t size)
+    {
+        uint64_t c = crc;
+
+        for (; size >= 8u; size -= 8u, data += 8u)
+        {
+            c = _mm_crc32_u64(c, impl_load_le64(data));
+        }
+
+        crc = static_cast<uint32_t>(c);
+
+        for (; size != 0; --size, ++data)
+        {
+            crc = _mm_crc32_u8(crc, *data);
+        }
+
+        return crc;
+    }
+
+    // Multiplies the crc register c by x^(8 * bytes), that is, appends that many zero bytes,
+    // where shift holds x^(8 * bytes - 33) from impl_crc32c_xpow
+    // the carry-less product is 64 bits, times x, and crc32 of it multiplies by x^32 and reduces
+    __attribute__((target("sse4.2,pclmul")))
+    inline uint64_t impl_crc32c_shift(uint64_t c, __m128i shift)
+    {
+        __m128i p = _mm_clmulepi64_si128(_mm_cvtsi32_si128(static_cast<int>(c)), shift, 0);
+        return _mm_crc32_u64(0, static_cast<uint64_t>(_mm_cvtsi128_si64(p)));
+    }
+
+    // SSE4.2 and PCLMULQDQ kernel
+    // The crc32 instruction has a latency of three cycles but a throughput of one,
+    // so three streams of block bytes are checksummed at once, then combined
+    // by shifting the earlier streams with a carry-less multiply
+    __attribute__((target("sse4.2,pclmul")))
+    inline uint32_t impl_crc32c_sse42_pclmul(uint32_t crc, const uint8_t* data, size_t size)
+    {
+        constexpr size_t block = 512;
+
+        constexpr uint32_t power = impl_crc32c_xpow(8u * block - 33u);
+        const __m128i shift = _mm_cvtsi32_si128(static_cast<int>(power));
+
+        uint64_t a = crc;
+
+        for (; size >= 3u * block; size -= 3u * block, data += 3u * block)
+        {
+            uint64_t b = 0;
+            uint64_t c = 0;
+
+            for (size_t i = 0; i != block; i += 8u)
+            {
+                a = _mm_crc32_u64(a, impl_load_le64(data + i));
+                b = _mm_crc32_u64(b, impl_load_le64(data + block + i));
+                c = _mm_crc32_u64(c, impl_load_le64(data + 2u * block + i));
+            }
+
+            a = impl_crc32c_shift(a, shift) ^ b;
+            a = impl_crc32c_shift(a, shift) ^ c;
+        }
+
+        return impl_crc32c_sse42(static_cast<uint32_t>(a), data, size);
+    }
+
+    // Returns the fastest crc kernel this cpu supports
+    inline impl_crc32c_func impl_select_crc32c()
+    {
+        __builtin_cpu_init();
+
+        if (__builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("pclmul"))
+        {
+            return &impl_crc32c_sse42_pclmul;
+        }
+
+        if (__builtin_cpu_supports("sse4.2"))
+        {
+            return &impl_crc32c_sse42;
+        }
+
+        return &impl_crc32c_table;
+    }
+#endif
+
+    // Returns the CRC-32C of size bytes, continuing from the crc of any previous bytes
+    // crc32c(b, m, crc32c(a, n)) is the crc of a followed by b
+    inline uint32_t crc32c(const void* data, size_t size, uint32_t crc = 0)
+    {
+    #ifdef K13_CRC32C_DISPATCH
+        static const impl_crc32c_func kernel = impl_select_crc32c();
+    #else
+        constexpr impl_crc32c_func kernel = &impl_crc32c_table;
+    #endif
+
+        return ~kernel(~crc, static_cast<const uint8_t*>(data), size);
+    }
+
+    // 64-bit product of a and b, folded from 128 bits
+    K13_INLINE_ATTRIBUTE
+    uint64_t impl_hash_mix(uint64_t a, uint64_t b)
+    {
+    #ifdef K13_INT128_SUPPORT
+        unsigned __int128 p = static_cast<unsigned __int128>(a) * b;
+        return static_cast<uint64_t>(p) ^ static_cast<uint64_t>(p >> 64u);
+    #else
+        uint64_t a_lo = a & 0xffffffffu;
+        uint64_t a_hi = a >> 32u;
+        uint64_t b_lo = b & 0xffffffffu;
+        uint64_t b_hi = b >> 32u;
+
+        uint64_t ll = a_lo * b_lo;
+        uint64_t lh = a_lo * b_hi;
+        uint64_t hl = a_hi * b_lo;
+        uint64_t hh = a_hi * b_hi;
+
+        uint64_t mid = (ll >> 32u) + (lh & 0xffffffffu) + (hl & 0xffffffffu);
+        uint64_t lo = (mid << 32u) | (ll & 0xffffffffu);
+        uint64_t hi = hh + (lh >> 32u) + (hl >> 32u) + (mid >> 32u);
+
+        return lo ^ hi;
+    #endif
+    }
+
+    // Returns a 64-bit hash of size bytes
+    // A fast non-cryptographic hash in the style of wyhash: each 16 bytes are folded
+    // into the state with one 64x64 to 128-bit multiply, and large inputs use four
+    // independent states so the multiplies overlap
+    // The result is the same on every platform
+    inline uint64_t hash64(const void* data, size_t size, uint64_t seed = 0)
+    {
+        constexpr uint64_t k[8] =
+        {
+            0xa0761d6478bd642full, 0xe7037ed1a0b428dbull, 0x8ebc6af09c88c6e3ull, 0x589965cc75374cc3ull,
+            0x1d8e4e27c47d124full, 0x9e3779b97f4a7c15ull, 0xc2b2ae3d27d4eb4full, 0x165667b19e3779f9ull,
+        };
+
+        auto p = static_cast<const uint8_t*>(data);
+        size_t remaining = size;
+
+        uint64_t s0 = seed ^ k[4];
+
+        if (remaining > 64u)
+        {
+            uint64_t s1 = seed ^ k[5];
+            uint64_t s2 = seed ^ k[6];
+            uint64_t s3 = seed ^ k[7];
+
+            do
+            {
+                s0 = impl_hash_mix(impl_load_le64(p) ^ k[0], impl_load_le64(p + 8u) ^ s0);
+                s1 = impl_hash_mix(impl_load_le64(p + 16u) ^ k[1], impl_load_le64(p + 24u) ^ s1);
+                s2 = impl_hash_mix(impl_load_le64(p + 32u) ^ k[2], impl_load_le64(p + 40u) ^ s2);
+                s3 = impl_hash_mix(impl_load_le64(p + 48u) ^ k[3], impl_load_le64(p + 56u) ^ s3);
+
+                p += 64u;
+                remaining -= 64u;
+            }
+            while (remaining > 64u);
+
+            s0 = impl_hash_mix(s0 ^ k[1], s1) ^ impl_hash_mix(s2 ^ k[2], s3);
+        }
+
+        for (; remaining > 16u; remaining -= 16u, p += 16u)
+        {
+            s0 = impl_hash_mix(impl_load_le64(p) ^ k[0], impl_load_le64(p + 8u) ^ s0);
+        }
+
+        // Last 1 to 16 bytes, zero padded, as the length is hashed below
+        uint8_t tail[16] = {};
+        if (remaining != 0)
+        {
+            memcpy(tail, p, remaining);
+        }
+
+        s0 = impl_hash_mix(impl_load_le64(tail) ^ k[1], impl_load_le64(tail + 8u) ^ s0);
+
+        return impl_hash_mix(s0 ^ k[2], static_cast<uint64_t>(size) ^ k[3]);
+    }
+
+    // Bytes swapped per step of a fused byteswap and checksum, small enough to stay in L1
+    constexpr size_t impl_fused_chunk_bytes = 8192;
+
+    // Byteswap n T from src to dst, and returns the CRC-32C of the swapped bytes,
+    // continuing from crc
+    // Works one cache-sized chunk at a time, so the swapped bytes are checksummed
+    // before they leave L1, and each byte passes through memory once
+    template<class T>
+    uint32_t byteswap_crc32c(T* dst, const T* src, size_t n, uint32_t crc = 0)
+    {
+        constexpr size_t chunk = (sizeof(T) < impl_fused_chunk_bytes) ? (impl_fused_chunk_bytes / sizeof(T)) : 1u;
+
+        for (size_t i = 0; i < n; i += chunk)
+        {
+            size_t m = (n - i < chunk) ? (n - i) : chunk;
+
+            byteswap(dst + i, src + i, m);
+            crc = crc32c(dst + i, m * sizeof(T), crc);
+        }
+
+        return crc;
+    }
+
+    // Byteswap n T in place, and returns the CRC-32C of the swapped bytes, continuing from crc
+    template<class T>
+    uint32_t byteswap_crc32c(T* x, size_t n, uint32_t crc = 0)
+    {
+        constexpr size_t chunk = (sizeof(T) < impl_fused_chunk_bytes) ? (impl_fused_chunk_bytes / sizeof(T)) : 1u;
+
+        for (size_t i = 0; i < n; i += chunk)
+        {
+            size_t m = (n - i < chunk) ? (n - i) : chunk;
+
+            byteswap(x + i, m);
+            crc = crc32c(x + i, m * sizeof(T), crc);
+        }
+
+        return crc;
+    }
+}
+
+#endif
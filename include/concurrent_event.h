@@ -0,0 +1,332 @@
+// k13
+// Kyle J Burgess
+
+#ifndef K13_CONCURRENT_EVENT_H
+#define K13_CONCURRENT_EVENT_H
+
+#include "event.h"
+#include "delegate.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace k13
+{
+    // Number of concurrent_event invokes running on this thread
+    inline size_t& impl_concurrent_invoke_depth()
+    {
+        static thread_local size_t depth = 0;
+        return depth;
+    }
+
+    // Concurrent Event
+    // An event that may be invoked, subscribed to and unsubscribed from by many threads at once
+    // invoke never locks: it reads an immutable snapshot of the subscribers, while
+    // subscribe and unsubscribe publish a new snapshot, and free the old one once no
+    // invoke can still be reading it (a read-copy-update grace period)
+    template<class... Args>
+    class concurrent_event
+    {
+    public:
+
+        // Function & Lambda binding
+        using func = delegate<callback_persistence(Args...)>;
+
+        // Member function binding
+        template<class T>
+        using pfunc = callback_persistence(T::*)(Args...);
+
+        // Member function binding (const)
+        template<class T>
+        using cpfunc = callback_persistence(T::*)(Args...) const;
+
+        // Constructor
+        concurrent_event()
+            : m_snapshot(new impl_snapshot())
+            , m_epoch(0)
+            , m_next_id(0)
+        {
+            m_readers[0].store(0);
+            m_readers[1].store(0);
+        }
+
+        // Copy Constructor
+        concurrent_event(const concurrent_event&) = delete;
+
+        // Copy-Assignment Operator
+        concurrent_event& operator=(const concurrent_event&) = delete;
+
+        // Destructor
+        // no thread may be using the event
+        ~concurrent_event()
+        {
+            delete m_snapshot.load();
+
+            for (auto s : m_retired)
+            {
+                delete s;
+            }
+        }
+
+        // Invokes the event with args
+        // calling all subscriber callbacks of the current snapshot
+        void invoke(Args... args)
+        {
+            // Registered until the end of the scope, even if a callback throws
+            impl_read_guard guard(*this);
+
+            const impl_snapshot* s = m_snapshot.load();
+
+            for (const auto& sub : s->subscribers)
+            {
+                if (sub->removed.load(std::memory_order_relaxed))
+                {
+                    continue;
+                }
+
+                if (sub->callback(args...) == remove_callback)
+                {
+                    // Stop future invokes, the snapshot is compacted by the next writer
+                    sub->removed.store(true, std::memory_order_relaxed);
+                }
+            }
+        }
+
+        // Subscribe to the event with a function, lambda or std::function
+        // returns an id that can be passed to unsubscribe
+        size_t add_callback(func func)
+        {
+            auto sub = std::make_shared<impl_subscriber>();
+            sub->callback = std::move(func);
+
+            std::vector<impl_snapshot*> retired;
+
+            {
+                std::lock_guard<std::mutex> lock(m_write_mtx);
+
+                sub->id = m_next_id++;
+
+                auto s = impl_copy_snapshot();
+                s->subscribers.push_back(sub);
+                impl_publish(s, retired);
+            }
+
+            impl_reclaim(retired);
+
+            return sub->id;
+        }
+
+        // Subscribe to the event with an object and a c-style function pointer (const)
+        template<class T>
+        size_t add_callback(std::shared_ptr<T> object, cpfunc<T> mem_func)
+        {
+            return add_callback([object = std::weak_ptr<T>(std::move(object)), mem_func](Args... args) -> callback_persistence
+            {
+                auto ptr = object.lock();
+
+                if (!ptr)
+                {
+                    return remove_callback;
+                }
+
+                return std::invoke(mem_func, ptr.get(), args...);
+            });
+        }
+
+        // Subscribe to the event with an object and a c-style function pointer
+        template<class T>
+        size_t add_callback(std::shared_ptr<T> object, pfunc<T> mem_func)
+        {
+            return add_callback([object = std::weak_ptr<T>(std::move(object)), mem_func](Args... args) -> callback_persistence
+            {
+                auto ptr = object.lock();
+
+                if (!ptr)
+                {
+                    return remove_callback;
+                }
+
+                return std::invoke(mem_func, ptr.get(), args...);
+            });
+        }
+
+        // Unsubscribe the callback with the id returned by add_callback
+        // invokes already running on other threads may still call it once
+        // returns false if the callback was already removed
+        bool unsubscribe(size_t id)
+        {
+            bool found = false;
+            std::vector<impl_snapshot*> retired;
+
+            {
+                std::lock_guard<std::mutex> lock(m_write_mtx);
+
+                for (const auto& sub : m_snapshot.load()->subscribers)
+                {
+                    if (sub->id == id && !sub->removed.exchange(true, std::memory_order_relaxed))
+                    {
+                        found = true;
+                    }
+                }
+
+                if (found)
+                {
+                    impl_publish(impl_copy_snapshot(), retired);
+                }
+            }
+
+            impl_reclaim(retired);
+
+            return found;
+        }
+
+        // Drops removed callbacks from the snapshot
+        void compact()
+        {
+            std::vector<impl_snapshot*> retired;
+
+            {
+                std::lock_guard<std::mutex> lock(m_write_mtx);
+                impl_publish(impl_copy_snapshot(), retired);
+            }
+
+            impl_reclaim(retired);
+        }
+
+        // Returns the number of callbacks in the current snapshot, including
+        // removed callbacks that have not been compacted yet
+        [[nodiscard]]
+        size_t size() const
+        {
+            std::lock_guard<std::mutex> lock(m_write_mtx);
+            return m_snapshot.load()->subscribers.size();
+        }
+
+    protected:
+
+        struct impl_subscriber
+        {
+            func callback;
+            size_t id = 0;
+            std::atomic<bool> removed { false };
+        };
+
+        struct impl_snapshot
+        {
+            std::vector<std::shared_ptr<impl_subscriber>> subscribers;
+        };
+
+        // Registers an invoke as a reader of the current epoch for its lifetime
+        struct impl_read_guard
+        {
+            concurrent_event& event;
+            size_t parity;
+
+            explicit impl_read_guard(concurrent_event& e)
+                : event(e)
+            {
+                ++impl_concurrent_invoke_depth();
+
+                parity = event.m_epoch.load() & 1u;
+                event.m_readers[parity].fetch_add(1);
+            }
+
+            ~impl_read_guard()
+            {
+                event.m_readers[parity].fetch_sub(1, std::memory_order_release);
+
+                --impl_concurrent_invoke_depth();
+            }
+        };
+
+        // Current snapshot
+        std::atomic<impl_snapshot*> m_snapshot;
+
+        // Grace period tracking, readers register on the counter of the current epoch's parity
+        std::atomic<size_t> m_epoch;
+        std::atomic<size_t> m_readers[2];
+
+        // Writers
+        mutable std::mutex m_write_mtx;
+        std::vector<impl_snapshot*> m_retired;
+        size_t m_next_id;
+
+        // Serializes grace periods, so the two epoch flips of one writer are never
+        // interleaved with another's, which could leave a counter unwaited
+        std::mutex m_grace_mtx;
+
+        // Copy the live subscribers into a new snapshot
+        impl_snapshot* impl_copy_snapshot() const
+        {
+            auto s = new impl_snapshot();
+            const auto& subscribers = m_snapshot.load()->subscribers;
+
+            s->subscribers.reserve(subscribers.size() + 1u);
+
+            for (const auto& sub : subscribers)
+            {
+                if (!sub->removed.load(std::memory_order_relaxed))
+                {
+                    s->subscribers.push_back(sub);
+                }
+            }
+
+            return s;
+        }
+
+        // Replace the current snapshot
+        // retired receives the old snapshots that can be freed after a grace period
+        void impl_publish(impl_snapshot* s, std::vector<impl_snapshot*>& retired)
+        {
+            m_retired.push_back(m_snapshot.exchange(s));
+
+            // Waiting from inside an invoke could wait on this thread's own read,
+            // so leave the old snapshots for the next writer
+            if (impl_concurrent_invoke_depth() == 0)
+            {
+                retired.swap(m_retired);
+            }
+        }
+
+        // Free retired snapshots once no invoke can still be reading them
+        // called without holding the write lock, so invokes that subscribe
+        // can make progress while this thread waits
+        void impl_reclaim(std::vector<impl_snapshot*>& retired)
+        {
+            if (retired.empty())
+            {
+                return;
+            }
+
+            impl_synchronize();
+
+            for (auto r : retired)
+            {
+                delete r;
+            }
+        }
+
+        // Wait until every invoke that could have read a retired snapshot has finished
+        void impl_synchronize()
+        {
+            std::lock_guard<std::mutex> lock(m_grace_mtx);
+
+            // Flipping the epoch sends new readers to the other counter, so
+            // each wait only covers readers that started before it
+            for (size_t i = 0; i != 2; ++i)
+            {
+                size_t parity = m_epoch.fetch_add(1) & 1u;
+
+                while (m_readers[parity].load(std::memory_order_acquire) != 0)
+                {
+                    std::this_thread::yield();
+                }
+            }
+        }
+    };
+}
+
+#endif
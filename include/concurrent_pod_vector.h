@@ -0,0 +1,317 @@
+// k13
+// Kyle J Burgess
+
+#ifndef K13_CONCURRENT_POD_VECTOR_H
+#define K13_CONCURRENT_POD_VECTOR_H
+
+#include "pod_span.h"
+
+#include <cstring>
+#include <cstdint>
+#include <cassert>
+#include <atomic>
+#include <type_traits>
+
+namespace k13
+{
+    // An append-only vector of POD types that many threads can write to at once
+    // Writers reserve a range with one atomic fetch-add and fill it without locking
+    // Storage is a list of chunks that double in size (2^BaseShift, 2^BaseShift, 2^(BaseShift+1), ...)
+    // so elements never move and the chunk of any index is found with one bit scan
+    // A reader sees the longest prefix of elements whose writes have been committed
+
+    template<class T, size_t BaseShift = 10>
+    class concurrent_pod_vector
+    {
+    public:
+
+        static_assert(BaseShift < 8 * sizeof(size_t), "concurrent_pod_vector BaseShift is too large");
+
+        // Maximum number of chunks
+        static constexpr size_t max_chunks = 8 * sizeof(size_t) - BaseShift + 1;
+
+        // Constructor
+        concurrent_pod_vector() : m_reserved(0), m_published(0)
+        {
+            static_assert(std::is_pod<T>::value, "concurrent_pod_vector template type T must be a POD type");
+
+            for (size_t k = 0; k != max_chunks; ++k)
+            {
+                m_chunks[k].store(nullptr, std::memory_order_relaxed);
+                m_committed[k].store(0, std::memory_order_relaxed);
+            }
+        }
+
+        // Copy Constructor
+        concurrent_pod_vector(const concurrent_pod_vector&) = delete;
+
+        // Copy-Assignment Operator
+        concurrent_pod_vector& operator=(const concurrent_pod_vector&) = delete;
+
+        // Destructor
+        ~concurrent_pod_vector()
+        {
+            for (size_t k = 0; k != max_chunks; ++k)
+            {
+                delete[] m_chunks[k].load(std::memory_order_relaxed);
+            }
+        }
+
+        // Reserves n elements and returns the index of the first
+        // the elements must be written and then committed with commit()
+        size_t reserve_range(size_t n)
+        {
+            size_t first = m_reserved.fetch_add(n, std::memory_order_relaxed);
+
+            if (n > 0)
+            {
+                size_t last = impl_chunk_index(first + n - 1u);
+                for (size_t k = impl_chunk_index(first); k <= last; ++k)
+                {
+                    impl_allocate_chunk(k);
+                }
+            }
+
+            return first;
+        }
+
+        // Publishes n elements starting at first, which must have been reserved and written
+        void commit(size_t first, size_t n)
+        {
+            while (n > 0)
+            {
+                size_t k = impl_chunk_index(first);
+                size_t count = impl_chunk_begin(k) + impl_chunk_length(k) - first;
+
+                if (count > n)
+                {
+                    count = n;
+                }
+
+                m_committed[k].fetch_add(count, std::memory_order_release);
+
+                first += count;
+                n -= count;
+            }
+        }
+
+        // Writes and publishes n elements starting at first, which must have been reserved
+        void write(size_t first, const T* src, size_t n)
+        {
+            size_t i = first;
+            size_t remaining = n;
+
+            while (remaining > 0)
+            {
+                size_t k = impl_chunk_index(i);
+                size_t offset = i - impl_chunk_begin(k);
+                size_t count = impl_chunk_length(k) - offset;
+
+                if (count > remaining)
+                {
+                    count = remaining;
+                }
+
+                memcpy(m_chunks[k].load(std::memory_order_relaxed) + offset, src, count * sizeof(T));
+
+                src += count;
+                i += count;
+                remaining -= count;
+            }
+
+            commit(first, n);
+        }
+
+        // Appends an element, returns its index
+        size_t push_back(const T& x)
+        {
+            size_t i = reserve_range(1);
+            operator[](i) = x;
+            commit(i, 1);
+            return i;
+        }
+
+        // Appends an array of n elements, returns the index of the first
+        size_t push_back(const T* src, size_t n)
+        {
+            size_t first = reserve_range(n);
+            write(first, src, n);
+            return first;
+        }
+
+        // Returns value at i
+        // i must be reserved by the caller, or below published()
+        template<class U>
+        T& operator[](U i)
+        {
+            size_t k = impl_chunk_index(static_cast<size_t>(i));
+            return m_chunks[k].load(std::memory_order_relaxed)[static_cast<size_t>(i) - impl_chunk_begin(k)];
+        }
+
+        // Returns const value at i
+        // i must be reserved by the caller, or below published()
+        template<class U>
+        const T& operator[](U i) const
+        {
+            size_t k = impl_chunk_index(static_cast<size_t>(i));
+            return m_chunks[k].load(std::memory_order_relaxed)[static_cast<size_t>(i) - impl_chunk_begin(k)];
+        }
+
+        // Returns the number of reserved elements, including those not yet published
+        [[nodiscard]]
+        size_t reserved() const
+        {
+            return m_reserved.load(std::memory_order_acquire);
+        }
+
+        // Returns n, such that all elements [0, n) are written and visible to the caller
+        // the result is a consistent snapshot, later calls never return less
+        [[nodiscard]]
+        size_t published() const
+        {
+            size_t n = impl_complete_prefix();
+            size_t last = m_published.load(std::memory_order_acquire);
+
+            // A new reservation in a partly written chunk hides that chunk's
+            // progress, so keep the furthest prefix seen so far
+            while (last < n && !m_published.compare_exchange_weak(last, n, std::memory_order_acq_rel))
+            {}
+
+            return (last > n) ? last : n;
+        }
+
+        // Calls f(pod_span<const T>) for the elements [0, n) chunk by chunk, in order
+        // n must not be greater than published()
+        template<class F>
+        void for_each_chunk(size_t n, F&& f) const
+        {
+            for (size_t k = 0; n > 0; ++k)
+            {
+                size_t count = (impl_chunk_length(k) < n) ? impl_chunk_length(k) : n;
+                f(pod_span<const T>(m_chunks[k].load(std::memory_order_relaxed), count));
+                n -= count;
+            }
+        }
+
+        // Copies the elements [0, n) into dst
+        // n must not be greater than published()
+        void copy(T* dst, size_t n) const
+        {
+            for_each_chunk(n, [&dst](pod_span<const T> chunk)
+            {
+                memcpy(dst, chunk.data(), chunk.size() * sizeof(T));
+                dst += chunk.size();
+            });
+        }
+
+        // Sets size to 0, chunks are kept for reuse
+        // must not be called while any thread is writing
+        void clear()
+        {
+            m_reserved.store(0, std::memory_order_relaxed);
+            m_published.store(0, std::memory_order_relaxed);
+
+            for (size_t k = 0; k != max_chunks; ++k)
+            {
+                m_committed[k].store(0, std::memory_order_relaxed);
+            }
+        }
+
+    protected:
+        std::atomic<T*> m_chunks[max_chunks];
+        std::atomic<size_t> m_committed[max_chunks];
+
+        // Kept apart from the chunk table, every writer hits it
+        alignas(64) std::atomic<size_t> m_reserved;
+
+        // Furthest complete prefix returned by published()
+        alignas(64) mutable std::atomic<size_t> m_published;
+
+        // Returns the length of a complete prefix of committed elements
+        size_t impl_complete_prefix() const
+        {
+            for (size_t k = 0; k != max_chunks; ++k)
+            {
+                size_t begin = impl_chunk_begin(k);
+                size_t length = impl_chunk_length(k);
+                size_t committed = m_committed[k].load(std::memory_order_acquire);
+
+                if (committed == length)
+                {
+                    continue;
+                }
+
+                // The chunk is partly written, it is complete only if every element
+                // reserved in it so far has been committed
+                size_t reserved = m_reserved.load(std::memory_order_acquire);
+                size_t end = (reserved < begin + length) ? reserved : (begin + length);
+
+                return (end > begin && committed == end - begin)
+                    ? end
+                    : begin;
+            }
+
+            return m_reserved.load(std::memory_order_acquire);
+        }
+
+        // Index of the chunk holding element i
+        static size_t impl_chunk_index(size_t i)
+        {
+            size_t x = i >> BaseShift;
+
+            if (x == 0)
+            {
+                return 0;
+            }
+
+        #if defined(__GNUC__)
+            return 8 * sizeof(unsigned long long) - static_cast<size_t>(__builtin_clzll(x));
+        #else
+            size_t r = 0;
+            for (; x != 0; x >>= 1u)
+            {
+                ++r;
+            }
+            return r;
+        #endif
+        }
+
+        // Index of the first element in chunk k
+        static size_t impl_chunk_begin(size_t k)
+        {
+            return (k == 0)
+                ? 0
+                : (size_t(1) << (BaseShift + k - 1u));
+        }
+
+        // Number of elements in chunk k
+        static size_t impl_chunk_length(size_t k)
+        {
+            return (k == 0)
+                ? (size_t(1) << BaseShift)
+                : (size_t(1) << (BaseShift + k - 1u));
+        }
+
+        // Allocates chunk k if no other thread has
+        void impl_allocate_chunk(size_t k)
+        {
+            assert(k < max_chunks);
+
+            if (m_chunks[k].load(std::memory_order_acquire) != nullptr)
+            {
+                return;
+            }
+
+            T* chunk = new T[impl_chunk_length(k)];
+            T* expected = nullptr;
+
+            if (!m_chunks[k].compare_exchange_strong(expected, chunk, std::memory_order_acq_rel))
+            {
+                // Another thread allocated the chunk first
+                delete[] chunk;
+            }
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,285 @@
+// k13
+// Kyle J Burgess
+
+#ifndef K13_DELEGATE_H
+#define K13_DELEGATE_H
+
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <new>
+
+namespace k13
+{
+    template<class Signature, size_t Size = 4 * sizeof(void*)>
+    class delegate;
+
+    // True if a delegate with Size bytes of storage holds Fn inline
+    template<class Fn, size_t Size>
+    struct impl_delegate_inline
+    {
+        static constexpr bool value =
+            sizeof(Fn) <= Size &&
+            alignof(Fn) <= alignof(std::max_align_t) &&
+            std::is_nothrow_move_constructible<Fn>::value;
+    };
+
+    // Delegate
+    // A callable wrapper like std::function, that stores callables of up to Size bytes
+    // inline without allocating, and dispatches through a plain function pointer
+    // Larger, over-aligned, or throwing-move callables are stored on the heap instead
+
+    template<class R, class... Args, size_t Size>
+    class delegate<R(Args...), Size>
+    {
+    public:
+
+        // Bytes of inline storage
+        static constexpr size_t storage_size = Size;
+
+        // True if a callable of type F is stored inline, without allocating
+        template<class F>
+        static constexpr bool stores_inline = impl_delegate_inline<typename std::decay<F>::type, Size>::value;
+
+        // Constructor
+        delegate() noexcept
+            : m_invoke(nullptr)
+            , m_manage(nullptr)
+        {}
+
+        // Constructor
+        delegate(std::nullptr_t) noexcept
+            : delegate()
+        {}
+
+        // Construct a delegate from a function pointer, lambda or function object
+        template<class F, class Fn = typename std::decay<F>::type, class = typename std::enable_if<
+            !std::is_same<Fn, delegate>::value &&
+            !std::is_same<Fn, std::nullptr_t>::value &&
+            std::is_invocable_r<R, Fn&, Args...>::value>::type>
+        delegate(F&& f)
+            : delegate()
+        {
+            // A null function pointer makes an empty delegate
+            if constexpr (std::is_pointer<Fn>::value || std::is_member_pointer<Fn>::value)
+            {
+                Fn ptr = f;
+                if (ptr == nullptr)
+                {
+                    return;
+                }
+            }
+
+            if constexpr (impl_delegate_inline<Fn, Size>::value)
+            {
+                new (m_storage) Fn(std::forward<F>(f));
+
+                m_invoke = &impl_invoke<Fn>;
+                m_manage = (std::is_trivially_copyable<Fn>::value && std::is_trivially_destructible<Fn>::value)
+                    ? nullptr
+                    : &impl_manage<Fn>;
+            }
+            else
+            {
+                // The storage holds a pointer to the callable
+                *reinterpret_cast<Fn**>(m_storage) = new Fn(std::forward<F>(f));
+
+                m_invoke = &impl_invoke_heap<Fn>;
+                m_manage = &impl_manage_heap<Fn>;
+            }
+        }
+
+        // Construct a delegate that calls a member function on an object
+        // the object must outlive the delegate
+        template<class T>
+        static delegate bind(T* object, R(T::*mem_func)(Args...))
+        {
+            return delegate([object, mem_func](Args... args) -> R
+            {
+                return (object->*mem_func)(std::forward<Args>(args)...);
+            });
+        }
+
+        // Construct a delegate that calls a const member function on an object
+        // the object must outlive the delegate
+        template<class T>
+        static delegate bind(const T* object, R(T::*mem_func)(Args...) const)
+        {
+            return delegate([object, mem_func](Args... args) -> R
+            {
+                return (object->*mem_func)(std::forward<Args>(args)...);
+            });
+        }
+
+        // Copy Constructor
+        delegate(const delegate& o)
+            : m_invoke(o.m_invoke)
+            , m_manage(o.m_manage)
+        {
+            impl_copy_from(o);
+        }
+
+        // Move Constructor
+        delegate(delegate&& o) noexcept
+            : m_invoke(o.m_invoke)
+            , m_manage(o.m_manage)
+        {
+            impl_move_from(o);
+        }
+
+        // Copy-Assignment Operator
+        delegate& operator=(const delegate& o)
+        {
+            if (this != &o)
+            {
+                impl_destroy();
+
+                m_invoke = o.m_invoke;
+                m_manage = o.m_manage;
+                impl_copy_from(o);
+            }
+
+            return *this;
+        }
+
+        // Move-Assignment Operator
+        delegate& operator=(delegate&& o) noexcept
+        {
+            if (this != &o)
+            {
+                impl_destroy();
+
+                m_invoke = o.m_invoke;
+                m_manage = o.m_manage;
+                impl_move_from(o);
+            }
+
+            return *this;
+        }
+
+        // Destructor
+        ~delegate()
+        {
+            impl_destroy();
+        }
+
+        // Calls the stored callable
+        R operator()(Args... args) const
+        {
+            return m_invoke(m_storage, std::forward<Args>(args)...);
+        }
+
+        // True if the delegate holds a callable
+        explicit operator bool() const
+        {
+            return m_invoke != nullptr;
+        }
+
+    protected:
+
+        static_assert(Size >= sizeof(void*), "delegate storage must hold at least a pointer");
+
+        enum impl_operation
+        {
+            impl_copy,
+            impl_move,
+            impl_destroy_op,
+        };
+
+        using impl_invoke_func = R(*)(void*, Args&&...);
+        using impl_manage_func = void(*)(impl_operation, void*, void*);
+
+        impl_invoke_func m_invoke;
+        impl_manage_func m_manage;
+        alignas(std::max_align_t) mutable unsigned char m_storage[Size];
+
+        template<class Fn>
+        static R impl_invoke(void* storage, Args&&... args)
+        {
+            return std::invoke(*static_cast<Fn*>(storage), std::forward<Args>(args)...);
+        }
+
+        template<class Fn>
+        static void impl_manage(impl_operation op, void* dst, void* src)
+        {
+            switch (op)
+            {
+                case impl_copy:
+                    new (dst) Fn(*static_cast<const Fn*>(src));
+                    break;
+                case impl_move:
+                    new (dst) Fn(std::move(*static_cast<Fn*>(src)));
+                    static_cast<Fn*>(src)->~Fn();
+                    break;
+                case impl_destroy_op:
+                    static_cast<Fn*>(dst)->~Fn();
+                    break;
+            }
+        }
+
+        template<class Fn>
+        static R impl_invoke_heap(void* storage, Args&&... args)
+        {
+            return std::invoke(**static_cast<Fn**>(storage), std::forward<Args>(args)...);
+        }
+
+        template<class Fn>
+        static void impl_manage_heap(impl_operation op, void* dst, void* src)
+        {
+            switch (op)
+            {
+                case impl_copy:
+                    *static_cast<Fn**>(dst) = new Fn(**static_cast<Fn* const*>(src));
+                    break;
+                case impl_move:
+                    *static_cast<Fn**>(dst) = *static_cast<Fn**>(src);
+                    break;
+                case impl_destroy_op:
+                    delete *static_cast<Fn**>(dst);
+                    break;
+            }
+        }
+
+        void impl_copy_from(const delegate& o)
+        {
+            if (m_manage != nullptr)
+            {
+                m_manage(impl_copy, m_storage, o.m_storage);
+            }
+            else if (m_invoke != nullptr)
+            {
+                memcpy(m_storage, o.m_storage, Size);
+            }
+        }
+
+        void impl_move_from(delegate& o)
+        {
+            if (m_manage != nullptr)
+            {
+                m_manage(impl_move, m_storage, o.m_storage);
+            }
+            else if (m_invoke != nullptr)
+            {
+                memcpy(m_storage, o.m_storage, Size);
+            }
+
+            o.m_invoke = nullptr;
+            o.m_manage = nullptr;
+        }
+
+        void impl_destroy()
+        {
+            if (m_manage != nullptr)
+            {
+                m_manage(impl_destroy_op, m_storage, nullptr);
+            }
+
+            m_invoke = nullptr;
+            m_manage = nullptr;
+        }
+    };
+}
+
+#endif
@@ -4,9 +4,17 @@
 #ifndef K13_EVENT_H
 #define K13_EVENT_H
 
+#include "delegate.h"
+
+#ifdef K13_EVENT_PROFILING
+#include "event_profiler.h"
+#endif
+
 #include <vector>
 #include <functional>
 #include <memory>
+#include <cstdint>
+#include <type_traits>
 
 namespace k13
 {
@@ -16,14 +24,89 @@ namespace k13
         remove_callback,
     };
 
+    // Subscription state shared by events and their connections
+    class impl_event_base
+    {
+    public:
+
+        virtual ~impl_event_base() = default;
+
+        // Removes the subscriber in slot, if it still has generation
+        virtual void impl_disconnect(uint32_t slot, uint32_t generation) = 0;
+
+        // True if the subscriber in slot still has generation
+        [[nodiscard]]
+        virtual bool impl_connected(uint32_t slot, uint32_t generation) const = 0;
+    };
+
+    // Event Connection
+    // Handle to an event subscription, returned by add_callback
+    class event_connection
+    {
+    public:
+
+        // Constructor
+        event_connection()
+            : m_slot(0)
+            , m_generation(0)
+        {}
+
+        // Constructor
+        event_connection(std::weak_ptr<impl_event_base> state, uint32_t slot, uint32_t generation)
+            : m_state(std::move(state))
+            , m_slot(slot)
+            , m_generation(generation)
+        {}
+
+        // Unsubscribes the callback in O(1)
+        // does nothing if the callback was already removed, or the event destroyed
+        void disconnect()
+        {
+            if (auto state = m_state.lock())
+            {
+                state->impl_disconnect(m_slot, m_generation);
+            }
+
+            m_state.reset();
+        }
+
+        // True if the callback is still subscribed
+        [[nodiscard]]
+        bool connected() const
+        {
+            auto state = m_state.lock();
+            return state && state->impl_connected(m_slot, m_generation);
+        }
+
+    protected:
+        std::weak_ptr<impl_event_base> m_state;
+        uint32_t m_slot;
+        uint32_t m_generation;
+    };
+
+    // Type an event passes an argument of type T to its subscribers as
+    // references and small trivially copyable values are passed as they are, anything
+    // else by const reference, so invoke never copies an argument per subscriber
+    template<class T>
+    using event_param_t = typename std::conditional<
+        std::is_reference<T>::value || (std::is_trivially_copyable<T>::value && sizeof(T) <= 2 * sizeof(void*)),
+        T,
+        const T&>::type;
+
     // Event
+    // Subscribers are stored inline as delegates in one contiguous array,
+    // so subscribing never allocates per subscriber and invoke walks dense memory
+    // Removed subscribers are left as tombstones and compacted in one pass after invoke,
+    // so callbacks may subscribe and unsubscribe (themselves or others) during invoke
+    // Events that forward to other events compile the whole forwarding tree into one
+    // flat dispatch list, rebuilt only for the events whose subtree changed
     template<class... Args>
     class event
     {
     public:
 
         // Function & Lambda binding
-        using func = std::function<callback_persistence(Args...)>;
+        using func = delegate<callback_persistence(event_param_t<Args>...)>;
 
         // Member function binding
         template<class T>
@@ -37,7 +120,9 @@ namespace k13
         using event_type = event<Args...>;
 
         // Constructor
-        event() = default;
+        event()
+            : m_state(std::make_shared<impl_state>())
+        {}
 
         // Copy Constructor
         event(const event&) = delete;
@@ -46,95 +131,684 @@ namespace k13
         event& operator=(const event&) = delete;
 
         // Destructor
-        ~event() = default;
+        // events forwarding to this event stop doing so
+        ~event()
+        {
+            m_state->closed = true;
+            m_state->impl_invalidate();
+        }
 
         // Invokes the event with args
-        // calling all subscriber callbacks
-        void invoke(Args... args)
+        // calling all subscriber callbacks, which all receive the same arguments
+        // callbacks subscribed during invoke are first called by the next invoke
+        void invoke(event_param_t<Args>... args)
         {
-            if (!m_subscribers.empty())
+#ifdef K13_EVENT_PROFILING
+            impl_profile_invoke profile(*m_state);
+#endif
+
+            impl_state& state = *m_state;
+
+            if (state.forwards != 0)
             {
-                for (auto it = m_subscribers.begin(); it != m_subscribers.end();)
+                impl_invoke_flat(args...);
+                return;
+            }
+
+            ++state.depth;
+
+            // Callbacks subscribed from here on go to pending, so this array is not reallocated
+            size_t n = state.subscribers.size();
+            for (size_t i = 0; i != n; ++i)
+            {
+                auto& sub = state.subscribers[i];
+
+                if (sub.slot == impl_state::npos)
                 {
-                    if (std::invoke(*it, args...) == persist_callback)
-                    {
-                        ++it;
-                    }
-                    else
-                    {
-                        it = m_subscribers.erase(it);
-                    }
+                    continue;
                 }
+
+                impl_call(state, sub, args...);
+            }
+
+            if (--state.depth == 0)
+            {
+                state.impl_flush();
             }
         }
 
         // Forward this event's invoke to another event
-        void forward(std::shared_ptr<event_type> e)
+        event_connection forward(std::shared_ptr<event_type> e)
         {
-            add_callback(std::move(e), &event::forward_invoke);
+            return impl_forward(std::move(e), persist_callback);
         }
 
         // Forward this event's invoke once to another event
-        void forward_once(std::shared_ptr<event_type> e)
+        event_connection forward_once(std::shared_ptr<event_type> e)
         {
-            add_callback(std::move(e), &event::forward_invoke_once);
+            return impl_forward(std::move(e), remove_callback);
         }
 
-        // Subscribe to the event with a std::function
-        void add_callback(func func)
+        // Subscribe to the event with a function, lambda or std::function
+        // an empty function is not subscribed, and returns a connection that is not connected
+        event_connection add_callback(func func)
         {
-            m_subscribers.push_back(std::move(func));
-        }
+            if (!func)
+            {
+                return event_connection();
+            }
 
+            return m_state->impl_add(std::move(func), m_state);
+        }
         // Subscribe to the event with an object and a c-style function pointer (const)
-        template<class T>
-        void add_callback(std::shared_ptr<T> object, cpfunc<T> mem_func)
+        // the function may take each argument by value or by const reference
+        // the callback is removed once the object is destroyed
+        template<class T, class... Params>
+        event_connection add_callback(std::shared_ptr<T> object, callback_persistence(T::*mem_func)(Params...) const)
+        {
+            return impl_add_member(std::weak_ptr<const T>(std::move(object)), mem_func);
+        }
+
+        // Subscribe to the event with a c-style function pointer
+        // the function may take each argument by value or by const reference
+        // the callback is removed once the object is destroyed
+        template<class T, class... Params>
+        event_connection add_callback(std::shared_ptr<T> object, callback_persistence(T::*mem_func)(Params...))
         {
-            m_subscribers.push_back([object = std::weak_ptr<T>(std::move(object)), mem_func](Args... args) -> callback_persistence
+            return impl_add_member(std::weak_ptr<T>(std::move(object)), mem_func);
+        }
+
+        // Subscribe to the event with an object and a c-style function pointer (const), without ownership tracking
+        // the object must outlive the subscription, or be disconnected before it is destroyed
+        template<class T, class... Params>
+        event_connection add_callback(const T* object, callback_persistence(T::*mem_func)(Params...) const)
+        {
+            return add_callback([object, mem_func](event_param_t<Args>... args) -> callback_persistence
             {
-                if (object.expired())
-                {
-                    return remove_callback;
-                }
+                return std::invoke(mem_func, object, args...);
+            });
+        }
 
-                return std::invoke(mem_func, object.lock().get(), args...);
+        // Subscribe to the event with an object and a c-style function pointer, without ownership tracking
+        // the object must outlive the subscription, or be disconnected before it is destroyed
+        template<class T, class... Params>
+        event_connection add_callback(T* object, callback_persistence(T::*mem_func)(Params...))
+        {
+            return add_callback([object, mem_func](event_param_t<Args>... args) -> callback_persistence
+            {
+                return std::invoke(mem_func, object, args...);
             });
         }
 
-        // Subscribe to the event with a c-style function pointer
-        template<class T>
-        void add_callback(std::shared_ptr<T> object, pfunc<T> mem_func)
+        // Returns the number of subscribed callbacks
+        [[nodiscard]]
+        size_t size() const
         {
-            m_subscribers.push_back([object = std::weak_ptr<T>(std::move(object)), mem_func](Args... args) -> callback_persistence
+            return m_state->count;
+        }
+
+        // Sets the name the event is traced with when profiling
+        // name must outlive the event
+        void set_name([[maybe_unused]] const char* name)
+        {
+#ifdef K13_EVENT_PROFILING
+            m_state->name = name;
+#endif
+        }
+
+#ifdef K13_EVENT_PROFILING
+        // Returns the profile of the event
+        [[nodiscard]]
+        const event_stats& stats() const
+        {
+            return m_state->stats;
+        }
+
+        // Returns the profiles of the subscribed callbacks, in the order they are called
+        [[nodiscard]]
+        std::vector<event_subscriber_stats> subscriber_stats() const
+        {
+            std::vector<event_subscriber_stats> stats;
+
+            for (const auto* list : { &m_state->subscribers, &m_state->pending })
             {
-                if (object.expired())
+                for (const auto& sub : *list)
                 {
-                    return remove_callback;
+                    if (sub.slot != impl_state::npos)
+                    {
+                        stats.push_back(sub.stats);
+                    }
                 }
+            }
 
-                return std::invoke(mem_func, object.lock().get(), args...);
-            });
+            return stats;
         }
+#endif
 
     protected:
 
-        // Subscribing functions
-        std::vector<func> m_subscribers;
+        struct impl_state;
+
+        // One entry of a flat dispatch list
+        struct impl_flat_entry
+        {
+            impl_state* state;
+            size_t index;
+        };
+
+        // Flat dispatch list of a forwarding tree
+        struct impl_flat
+        {
+            // Subscribers in the order nested invokes would call them
+            std::vector<impl_flat_entry> entries;
+
+            // True if a forwarding cycle was cut, the list then only holds for invokes of its own event
+            bool cut = false;
+
+            // Events the entries belong to, events with nothing to call are left out
+            std::vector<std::shared_ptr<impl_state>> states;
+        };
+
+        // Forwarding target of a forwarding subscriber
+        struct impl_forward_target
+        {
+            std::weak_ptr<impl_state> state;
+            callback_persistence persistence;
+        };
+
+        struct impl_state : impl_event_base
+        {
+            static constexpr uint32_t npos = UINT32_MAX;
+
+            struct impl_subscriber
+            {
+                impl_subscriber(func f, uint32_t s, bool fwd)
+                    : callback(std::move(f))
+                    , slot(s)
+                    , forwarding(fwd)
+                {
+#ifdef K13_EVENT_PROFILING
+                    stats.slot = s;
+#endif
+                }
+
+                // Empty for forwarding subscribers
+                func callback;
+                uint32_t slot;
+
+                // True if the subscriber forwards to the event in targets[slot]
+                bool forwarding;
+
+#ifdef K13_EVENT_PROFILING
+                event_subscriber_stats stats;
+#endif
+            };
+
+            struct impl_slot
+            {
+                // Index into subscribers, or into pending if pending_bit is set
+                size_t position;
+                uint32_t generation;
+            };
+
+            static constexpr size_t pending_bit = ~(~size_t(0) >> 1u);
+
+            // Subscribing functions, removed subscribers have slot npos
+            std::vector<impl_subscriber> subscribers;
+
+            // Functions subscribed during invoke
+            std::vector<impl_subscriber> pending;
+
+            // Connection slots, and the free slots for reuse
+            std::vector<impl_slot> slots;
+            std::vector<uint32_t> free_slots;
+
+            // Forwarding targets by slot
+            std::vector<impl_forward_target> targets;
+
+            // Events forwarding to this event
+            std::vector<std::weak_ptr<impl_state>> sources;
+
+            // Flat dispatch list, null when it must be rebuilt
+            std::shared_ptr<const impl_flat> flat;
+
+            // Number of live subscribers, of tombstones in subscribers, and of forwarding subscribers
+            size_t count = 0;
+            size_t tombstones = 0;
+            size_t forwards = 0;
+
+            // Number of invokes running
+            size_t depth = 0;
+
+            // True while the flat dispatch list is being built
+            bool building = false;
+
+            // True once the event is destroyed
+            bool closed = false;
+
+#ifdef K13_EVENT_PROFILING
+            const char* name = "event";
+            event_stats stats;
+#endif
+
+            event_connection impl_add(func func, const std::shared_ptr<impl_state>& self)
+            {
+                uint32_t slot = impl_insert(std::move(func), false);
+                return event_connection(self, slot, slots[slot].generation);
+            }
+
+            // Subscribe a forwarding target
+            event_connection impl_add_forward(const std::shared_ptr<impl_state>& target, callback_persistence persistence, const std::shared_ptr<impl_state>& self)
+            {
+                uint32_t slot = impl_insert(func(), true);
+
+                if (targets.size() < slots.size())
+                {
+                    targets.resize(slots.size());
+                }
+
+                targets[slot] = { target, persistence };
+                ++forwards;
+
+                // Let the target invalidate this event's flat dispatch list
+                bool found = false;
+                for (const auto& source : target->sources)
+                {
+                    if (!source.owner_before(self) && !self.owner_before(source))
+                    {
+                        found = true;
+                        break;
+                    }
+                }
+
+                if (!found)
+                {
+                    target->sources.push_back(self);
+                }
+
+                return event_connection(self, slot, slots[slot].generation);
+            }
+
+            // Store a subscriber, and return its slot
+            uint32_t impl_insert(func func, bool forwarding)
+            {
+                uint32_t slot;
+
+                if (free_slots.empty())
+                {
+                    slot = static_cast<uint32_t>(slots.size());
+                    slots.push_back({ 0, 0 });
+                }
+                else
+                {
+                    slot = free_slots.back();
+                    free_slots.pop_back();
+                }
+
+                if (depth == 0)
+                {
+                    // Keep tombstones from piling up between invokes
+                    if (tombstones > subscribers.size() / 2u)
+                    {
+                        impl_compact();
+                    }
+
+                    slots[slot].position = subscribers.size();
+                    subscribers.emplace_back(std::move(func), slot, forwarding);
+                    impl_invalidate();
+                }
+                else
+                {
+                    slots[slot].position = pending.size() | pending_bit;
+                    pending.emplace_back(std::move(func), slot, forwarding);
+                }
+
+                ++count;
+
+                return slot;
+            }
+
+            // Tombstone a subscriber, and free its slot
+            void impl_remove(impl_subscriber& sub)
+            {
+                impl_slot& s = slots[sub.slot];
+
+                ++s.generation;
+                free_slots.push_back(sub.slot);
+
+                if (sub.forwarding)
+                {
+                    targets[sub.slot].state.reset();
+                    --forwards;
+                }
+
+                sub.slot = npos;
+                --count;
+
+#ifdef K13_EVENT_PROFILING
+                ++stats.removals;
+#endif
+
+                if ((s.position & pending_bit) == 0)
+                {
+                    ++tombstones;
+                    impl_invalidate();
+                }
+            }
+
+            void impl_disconnect(uint32_t slot, uint32_t generation) override
+            {
+                if (!impl_connected(slot, generation))
+                {
+                    return;
+                }
+
+                size_t position = slots[slot].position;
+
+                if (position & pending_bit)
+                {
+                    impl_remove(pending[position & ~pending_bit]);
+                }
+                else
+                {
+                    impl_remove(subscribers[position]);
+                }
+            }
+
+            bool impl_connected(uint32_t slot, uint32_t generation) const override
+            {
+                return !closed && slot < slots.size() && slots[slot].generation == generation;
+            }
+
+            // Compact tombstones and append pending subscribers after the outermost invoke
+            void impl_flush()
+            {
+                if (tombstones > 0)
+                {
+                    impl_compact();
+                }
+
+                if (!pending.empty())
+                {
+                    for (auto& sub : pending)
+                    {
+                        if (sub.slot != npos)
+                        {
+                            slots[sub.slot].position = subscribers.size();
+                            subscribers.push_back(std::move(sub));
+                        }
+                    }
 
-        // Forward invoke a forwarded event
-        callback_persistence forward_invoke(Args... args)
+                    pending.clear();
+                    impl_invalidate();
+                }
+            }
+
+            // Remove tombstones in one stable pass
+            void impl_compact()
+            {
+                size_t w = 0;
+
+                for (size_t r = 0; r != subscribers.size(); ++r)
+                {
+                    if (subscribers[r].slot == npos)
+                    {
+                        continue;
+                    }
+
+                    if (w != r)
+                    {
+                        subscribers[w] = std::move(subscribers[r]);
+                    }
+
+                    slots[subscribers[w].slot].position = w;
+                    ++w;
+                }
+
+                subscribers.erase(subscribers.begin() + static_cast<std::ptrdiff_t>(w), subscribers.end());
+                tombstones = 0;
+                impl_invalidate();
+            }
+
+            // Drop the flat dispatch lists of this event and every event forwarding to it
+            // a valid list implies valid lists below it, so this stops at invalid events
+            void impl_invalidate()
+            {
+                if (flat == nullptr)
+                {
+                    return;
+                }
+
+                // Released on return, the list may hold the last reference to a forwarded event
+                auto old = std::move(flat);
+
+                for (size_t i = 0; i != sources.size();)
+                {
+                    if (auto source = sources[i].lock())
+                    {
+                        source->impl_invalidate();
+                        ++i;
+                    }
+                    else
+                    {
+                        sources[i] = std::move(sources.back());
+                        sources.pop_back();
+                    }
+                }
+            }
+
+            // Returns the flat dispatch list, building it and the lists of forwarded events if needed
+            std::shared_ptr<const impl_flat> impl_get_flat(const std::shared_ptr<impl_state>& self)
+            {
+                if (flat == nullptr)
+                {
+                    flat = impl_build_flat(self);
+                }
+
+                return flat;
+            }
+
+            // Builds the flat dispatch list, reusing the cached lists of forwarded events
+            // forwarding cycles are cut where they return to an event whose list is being built,
+            // so a cut list is rebuilt when another event forwards to it, and each event
+            // invoked calls every event it reaches once
+            std::shared_ptr<const impl_flat> impl_build_flat(const std::shared_ptr<impl_state>& self)
+            {
+                auto f = std::make_shared<impl_flat>();
+                bool has_entries = false;
+
+                building = true;
+
+                for (size_t i = 0; i != subscribers.size(); ++i)
+                {
+                    auto& sub = subscribers[i];
+
+                    if (sub.slot == npos)
+                    {
+                        continue;
+                    }
+
+                    if (!sub.forwarding)
+                    {
+                        f->entries.push_back({ this, i });
+                        has_entries = true;
+                        continue;
+                    }
+
+                    const impl_forward_target& target = targets[sub.slot];
+                    auto target_state = target.state.lock();
+
+                    if (!target_state || target_state->closed)
+                    {
+                        impl_remove(sub);
+                        continue;
+                    }
+
+                    if (target_state->building)
+                    {
+                        f->cut = true;
+                    }
+                    else
+                    {
+                        std::shared_ptr<const impl_flat> target_flat = target_state->flat;
+
+                        if (target_flat == nullptr || target_flat->cut)
+                        {
+                            target_flat = target_state->impl_build_flat(target_state);
+
+                            // A list cut at an event further up this build only holds for this build
+                            if (!target_flat->cut)
+                            {
+                                target_state->flat = target_flat;
+                            }
+                        }
+
+                        f->cut = f->cut || target_flat->cut;
+                        f->entries.insert(f->entries.end(), target_flat->entries.begin(), target_flat->entries.end());
+                        f->states.insert(f->states.end(), target_flat->states.begin(), target_flat->states.end());
+                    }
+
+                    // Forward once subscribers remove themselves after their subtree is called
+                    if (target.persistence == remove_callback)
+                    {
+                        f->entries.push_back({ this, i });
+                        has_entries = true;
+                    }
+                }
+
+                if (has_entries)
+                {
+                    f->states.push_back(self);
+                }
+
+                building = false;
+
+                return f;
+            }
+        };
+
+        std::shared_ptr<impl_state> m_state;
+
+        // Subscribe a member function through a weak_ptr, locked once per call
+        template<class P, class F>
+        event_connection impl_add_member(P object, F mem_func)
         {
-            invoke(args...);
-            return persist_callback;
+            return add_callback([object = std::move(object), mem_func](event_param_t<Args>... args) -> callback_persistence
+            {
+                auto ptr = object.lock();
+
+                if (!ptr)
+                {
+                    return remove_callback;
+                }
+
+                return std::invoke(mem_func, ptr.get(), args...);
+            });
         }
 
-        // Forward invoke a forwarded event once
-        callback_persistence forward_invoke_once(Args... args)
+        // Subscribe another event's invoke
+        event_connection impl_forward(std::shared_ptr<event_type> e, callback_persistence persistence)
         {
-            invoke(args...);
-            return remove_callback;
+            return m_state->impl_add_forward(e->m_state, persistence, m_state);
+        }
+
+        // Call a subscriber, and remove it if it asks to be
+        static void impl_call(impl_state& state, typename impl_state::impl_subscriber& sub, event_param_t<Args>... args)
+        {
+#ifdef K13_EVENT_PROFILING
+            uint64_t start = event_profiler::now();
+            callback_persistence r = sub.callback(args...);
+            uint64_t duration = event_profiler::now() - start;
+
+            // sub is not moved by the call, subscribers are only compacted after the outermost invoke
+            ++sub.stats.calls;
+            sub.stats.total_ns += duration;
+            sub.stats.max_ns = (duration > sub.stats.max_ns) ? duration : sub.stats.max_ns;
+
+            event_profiler::instance().record(state.name, sub.stats.slot, start, duration);
+
+            // The callback may have disconnected itself before asking to be removed
+            if (r == remove_callback && sub.slot != impl_state::npos)
+            {
+                state.impl_remove(sub);
+            }
+#else
+            // The callback may have disconnected itself before asking to be removed
+            if (sub.callback(args...) == remove_callback && sub.slot != impl_state::npos)
+            {
+                state.impl_remove(sub);
+            }
+#endif
         }
 
+#ifdef K13_EVENT_PROFILING
+        // Times one invoke of an event
+        struct impl_profile_invoke
+        {
+            impl_state& state;
+            uint64_t start;
+
+            explicit impl_profile_invoke(impl_state& s)
+                : state(s)
+                , start(event_profiler::now())
+            {}
+
+            ~impl_profile_invoke()
+            {
+                uint64_t duration = event_profiler::now() - start;
+
+                ++state.stats.invokes;
+                state.stats.total_ns += duration;
+                state.stats.max_ns = (duration > state.stats.max_ns) ? duration : state.stats.max_ns;
+            }
+        };
+#endif
+
+        // Invoke through the flat dispatch list
+        void impl_invoke_flat(event_param_t<Args>... args)
+        {
+            // Holding the list keeps its events alive, and lets callbacks invalidate it
+            std::shared_ptr<const impl_flat> f = m_state->impl_get_flat(m_state);
+
+            for (const auto& state : f->states)
+            {
+                ++state->depth;
+            }
+
+            for (const auto& entry : f->entries)
+            {
+                impl_state& state = *entry.state;
+
+                if (state.closed)
+                {
+                    continue;
+                }
+
+                auto& sub = state.subscribers[entry.index];
+
+                if (sub.slot == impl_state::npos)
+                {
+                    continue;
+                }
+
+                if (sub.forwarding)
+                {
+                    // Forward once subscriber
+                    state.impl_remove(sub);
+                    continue;
+                }
+
+                impl_call(state, sub, args...);
+            }
+
+            for (const auto& state : f->states)
+            {
+                if (--state->depth == 0)
+                {
+                    state->impl_flush();
+                }
+            }
+        }
     };
 }
 
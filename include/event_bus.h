@@ -0,0 +1,223 @@
+// k13
+// Kyle J Burgess
+
+#ifndef K13_EVENT_BUS_H
+#define K13_EVENT_BUS_H
+
+#include "event.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace k13
+{
+    // Event Bus
+    // Publish/subscribe by topic name, where every topic name is interned into a dense
+    // integer id, so publishing by id is one array lookup and one event invoke
+    // Prefix subscriptions are forwarded events, which each topic's event compiles
+    // into its own flat dispatch list, so publishing never matches prefixes
+    // Subscribers of a topic are called in subscription order, with each matching
+    // prefix called at the point its prefix was first matched to the topic
+    template<class... Args>
+    class event_bus
+    {
+    public:
+
+        // Type of each topic's event
+        using event_type = event<Args...>;
+
+        // Function & Lambda binding
+        using func = typename event_type::func;
+
+        // Interned topic
+        using topic_id = uint32_t;
+
+        // Id of no topic
+        static constexpr topic_id npos = UINT32_MAX;
+
+        // Constructor
+        event_bus() = default;
+
+        // Copy Constructor
+        event_bus(const event_bus&) = delete;
+
+        // Copy-Assignment Operator
+        event_bus& operator=(const event_bus&) = delete;
+
+        // Returns the id of a topic, interning it if it is new
+        topic_id intern(std::string_view topic)
+        {
+            auto it = m_ids.find(topic);
+
+            if (it != m_ids.end())
+            {
+                return it->second;
+            }
+
+            auto id = static_cast<topic_id>(m_names.size());
+
+            m_names.emplace_back(topic);
+            m_ids.emplace(m_names.back(), id);
+            m_topics.emplace_back();
+
+            // Forward the new topic to the prefix subscriptions it matches
+            for (size_t length : m_prefix_lengths)
+            {
+                if (length > topic.size())
+                {
+                    continue;
+                }
+
+                auto prefix = m_prefixes.find(topic.substr(0, length));
+
+                if (prefix != m_prefixes.end())
+                {
+                    impl_topic_event(id).forward(prefix->second);
+                }
+            }
+
+            return id;
+        }
+
+        // Returns the id of a topic, or npos if it was never interned
+        [[nodiscard]]
+        topic_id find(std::string_view topic) const
+        {
+            auto it = m_ids.find(topic);
+
+            return (it != m_ids.end())
+                ? it->second
+                : npos;
+        }
+
+        // Returns the name of a topic
+        [[nodiscard]]
+        const std::string& name(topic_id id) const
+        {
+            assert(id < m_names.size());
+            return m_names[id];
+        }
+
+        // Returns the number of interned topics
+        [[nodiscard]]
+        size_t size() const
+        {
+            return m_names.size();
+        }
+
+        // Subscribe to a topic
+        event_connection subscribe(topic_id id, func func)
+        {
+            assert(id < m_topics.size());
+            return impl_topic_event(id).add_callback(std::move(func));
+        }
+
+        // Subscribe to a topic by name
+        event_connection subscribe(std::string_view topic, func func)
+        {
+            return subscribe(intern(topic), std::move(func));
+        }
+
+        // Subscribe to every topic whose name starts with prefix, including topics interned later
+        // an empty prefix subscribes to every topic
+        event_connection subscribe_prefix(std::string_view prefix, func func)
+        {
+            auto it = m_prefixes.find(prefix);
+
+            if (it == m_prefixes.end())
+            {
+                m_prefix_names.emplace_back(prefix);
+
+                it = m_prefixes.emplace(m_prefix_names.back(), std::make_shared<event_type>()).first;
+
+                if (std::find(m_prefix_lengths.begin(), m_prefix_lengths.end(), prefix.size()) == m_prefix_lengths.end())
+                {
+                    m_prefix_lengths.push_back(prefix.size());
+                }
+
+                // Forward the existing topics it matches
+                for (topic_id id = 0; id != m_names.size(); ++id)
+                {
+                    if (std::string_view(m_names[id]).substr(0, prefix.size()) == prefix)
+                    {
+                        impl_topic_event(id).forward(it->second);
+                    }
+                }
+            }
+
+            return it->second->add_callback(std::move(func));
+        }
+
+        // Publish to a topic
+        void publish(topic_id id, event_param_t<Args>... args)
+        {
+            assert(id < m_topics.size());
+
+            if (auto& e = m_topics[id])
+            {
+                e->invoke(args...);
+            }
+        }
+
+        // Publish to a topic by name
+        // does nothing if the topic was never interned, and so has no subscribers
+        void publish(std::string_view topic, event_param_t<Args>... args)
+        {
+            topic_id id = find(topic);
+
+            if (id != npos)
+            {
+                publish(id, args...);
+            }
+        }
+
+        // Returns the number of subscribers called when publishing to a topic,
+        // counting each matching prefix as one
+        [[nodiscard]]
+        size_t subscribers(topic_id id) const
+        {
+            assert(id < m_topics.size());
+
+            return (m_topics[id] != nullptr)
+                ? m_topics[id]->size()
+                : 0;
+        }
+
+    protected:
+
+        // Topic names, a deque so that the views in m_ids stay valid
+        std::deque<std::string> m_names;
+        std::unordered_map<std::string_view, topic_id> m_ids;
+
+        // Topic events by id, null until a topic has subscribers
+        std::vector<std::shared_ptr<event_type>> m_topics;
+
+        // Prefix subscriptions, as events forwarded to by each matching topic,
+        // and the distinct prefix lengths to look up when interning
+        std::deque<std::string> m_prefix_names;
+        std::unordered_map<std::string_view, std::shared_ptr<event_type>> m_prefixes;
+        std::vector<size_t> m_prefix_lengths;
+
+        // Returns the event of a topic, creating it if needed
+        event_type& impl_topic_event(topic_id id)
+        {
+            auto& e = m_topics[id];
+
+            if (e == nullptr)
+            {
+                e = std::make_shared<event_type>();
+            }
+
+            return *e;
+        }
+    };
+}
+
+#endif
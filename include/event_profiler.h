@@ -0,0 +1,189 @@
+// k13
+// Kyle J Burgess
+
+#ifndef K13_EVENT_PROFILER_H
+#define K13_EVENT_PROFILER_H
+
+// Event profiling is opt-in, define K13_EVENT_PROFILING before including event.h
+// (or for the whole target) to record call counts, latencies and a trace of recent calls
+// Without it, event compiles without any profiling code
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+namespace k13
+{
+    // Profile of one event
+    struct event_stats
+    {
+        uint64_t invokes = 0;
+        uint64_t total_ns = 0;
+        uint64_t max_ns = 0;
+
+        // Subscribers that removed themselves, or were disconnected
+        uint64_t removals = 0;
+    };
+
+    // Profile of one event subscriber
+    struct event_subscriber_stats
+    {
+        // Connection slot of the subscriber
+        uint32_t slot = 0;
+
+        uint64_t calls = 0;
+        uint64_t total_ns = 0;
+        uint64_t max_ns = 0;
+    };
+
+    // Event Profiler
+    // Keeps a ring buffer trace of the most recent subscriber calls of every event,
+    // which can be exported for chrome://tracing or Perfetto
+    class event_profiler
+    {
+    public:
+
+        // One traced subscriber call
+        struct trace_entry
+        {
+            const char* event_name;
+            uint32_t slot;
+            uint64_t thread;
+            uint64_t start_ns;
+            uint64_t duration_ns;
+        };
+
+        // Returns the profiler shared by every event
+        static event_profiler& instance()
+        {
+            static event_profiler profiler;
+            return profiler;
+        }
+
+        // Returns the current time in nanoseconds
+        static uint64_t now()
+        {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+
+        // Record a subscriber call in the trace
+        void record(const char* event_name, uint32_t slot, uint64_t start_ns, uint64_t duration_ns)
+        {
+            static thread_local uint64_t thread = std::hash<std::thread::id>()(std::this_thread::get_id());
+
+            std::lock_guard<std::mutex> lock(m_mtx);
+
+            if (m_trace.empty())
+            {
+                return;
+            }
+
+            m_trace[m_next % m_trace.size()] = { event_name, slot, thread, start_ns, duration_ns };
+            ++m_next;
+        }
+
+        // Sets the number of most recent calls kept, and clears the trace
+        // zero disables tracing
+        void set_trace_capacity(size_t capacity)
+        {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            m_trace.assign(capacity, trace_entry());
+            m_next = 0;
+        }
+
+        // Clears the trace
+        void clear()
+        {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            m_next = 0;
+        }
+
+        // Returns the traced calls, oldest first
+        [[nodiscard]]
+        std::vector<trace_entry> trace() const
+        {
+            std::lock_guard<std::mutex> lock(m_mtx);
+
+            std::vector<trace_entry> entries;
+
+            size_t n = (m_next < m_trace.size()) ? m_next : m_trace.size();
+            entries.reserve(n);
+
+            for (size_t i = m_next - n; i != m_next; ++i)
+            {
+                entries.push_back(m_trace[i % m_trace.size()]);
+            }
+
+            return entries;
+        }
+
+        // Writes the trace in the Chrome trace event JSON format
+        // each subscriber call is a complete event named after its event and slot
+        void export_chrome_trace(std::ostream& out) const
+        {
+            auto entries = trace();
+
+            out << "{\"traceEvents\":[";
+
+            for (size_t i = 0; i != entries.size(); ++i)
+            {
+                const trace_entry& e = entries[i];
+
+                out << ((i == 0) ? "\n" : ",\n");
+                out << "{\"name\":\"";
+                impl_write_escaped(out, e.event_name);
+                out << "#" << e.slot << "\",\"cat\":\"event\",\"ph\":\"X\",\"pid\":0";
+                out << ",\"tid\":" << (e.thread & 0xffffffffu);
+                out << ",\"ts\":";
+                impl_write_us(out, e.start_ns);
+                out << ",\"dur\":";
+                impl_write_us(out, e.duration_ns);
+                out << "}";
+            }
+
+            out << "\n],\"displayTimeUnit\":\"ns\"}\n";
+        }
+
+    protected:
+
+        mutable std::mutex m_mtx;
+        std::vector<trace_entry> m_trace = std::vector<trace_entry>(4096);
+        size_t m_next = 0;
+
+        event_profiler() = default;
+
+        // Write nanoseconds as microseconds, with three decimals
+        static void impl_write_us(std::ostream& out, uint64_t ns)
+        {
+            uint64_t f = ns % 1000u;
+
+            out << (ns / 1000u) << '.'
+                << static_cast<char>('0' + f / 100u)
+                << static_cast<char>('0' + (f / 10u) % 10u)
+                << static_cast<char>('0' + f % 10u);
+        }
+
+        static void impl_write_escaped(std::ostream& out, const char* s)
+        {
+            for (; *s != '\0'; ++s)
+            {
+                if (*s == '"' || *s == '\\')
+                {
+                    out << '\\';
+                }
+
+                if (static_cast<unsigned char>(*s) >= 0x20u)
+                {
+                    out << *s;
+                }
+            }
+        }
+    };
+}
+
+#endif
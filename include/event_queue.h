@@ -0,0 +1,362 @@
+// k13
+// Kyle J Burgess
+
+#ifndef K13_EVENT_QUEUE_H
+#define K13_EVENT_QUEUE_H
+
+#include "event.h"
+#include "pod_span.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+
+namespace k13
+{
+    enum event_queue_producers
+    {
+        single_producer,
+        multiple_producers,
+    };
+
+    // Event Queue
+    // A bounded lock-free ring of event argument tuples, for handing events to a consumer thread
+    // Producers push arguments, and the consumer drains them into its own events
+    // A batched drain invokes once per contiguous run of queued tuples, which is
+    // at most twice per drain since the ring wraps once
+    // With multiple_producers any number of threads may push, with single_producer only one
+    // Only one thread may drain or wait at a time
+    template<event_queue_producers Producers, class... Args>
+    class event_queue
+    {
+    public:
+
+        static_assert(!std::disjunction<std::is_reference<Args>...>::value, "event_queue arguments are stored, and cannot be references");
+        static_assert(std::is_default_constructible<std::tuple<Args...>>::value, "event_queue arguments must be default constructible");
+
+        // Stored arguments of one event
+        using value_type = std::tuple<Args...>;
+
+        // Event invoked once per message
+        using event_type = event<Args...>;
+
+        // Event invoked once per batch
+        using batch_event_type = event<pod_span<const value_type>>;
+
+        // Constructor
+        // capacity is rounded up to a power of two
+        explicit event_queue(size_t capacity)
+            : m_mask(impl_round_capacity(capacity) - 1u)
+            , m_values(new value_type[m_mask + 1u])
+            , m_head(0)
+            , m_cached_tail(0)
+            , m_tail(0)
+            , m_cached_head(0)
+            , m_parked(false)
+        {
+            if constexpr (Producers == multiple_producers)
+            {
+                m_sequence.reset(new std::atomic<size_t>[m_mask + 1u]);
+
+                for (size_t i = 0; i != m_mask + 1u; ++i)
+                {
+                    m_sequence[i].store(i, std::memory_order_relaxed);
+                }
+            }
+        }
+
+        // Copy Constructor
+        event_queue(const event_queue&) = delete;
+
+        // Copy-Assignment Operator
+        event_queue& operator=(const event_queue&) = delete;
+
+        // Queue an event, returns false if the queue is full
+        bool try_push(Args... args)
+        {
+            size_t pos;
+
+            if constexpr (Producers == single_producer)
+            {
+                pos = m_tail.load(std::memory_order_relaxed);
+
+                if (pos - m_cached_head > m_mask)
+                {
+                    m_cached_head = m_head.load(std::memory_order_acquire);
+
+                    if (pos - m_cached_head > m_mask)
+                    {
+                        return false;
+                    }
+                }
+
+                m_values[pos & m_mask] = value_type(std::move(args)...);
+                m_tail.store(pos + 1u, std::memory_order_release);
+            }
+            else
+            {
+                pos = m_tail.load(std::memory_order_relaxed);
+
+                while (true)
+                {
+                    size_t sequence = m_sequence[pos & m_mask].load(std::memory_order_acquire);
+                    auto diff = static_cast<std::ptrdiff_t>(sequence - pos);
+
+                    if (diff == 0)
+                    {
+                        // The slot is free, claim it
+                        if (m_tail.compare_exchange_weak(pos, pos + 1u, std::memory_order_relaxed))
+                        {
+                            break;
+                        }
+                    }
+                    else if (diff < 0)
+                    {
+                        // The slot still holds an event a lap behind, the queue is full
+                        return false;
+                    }
+                    else
+                    {
+                        pos = m_tail.load(std::memory_order_relaxed);
+                    }
+                }
+
+                m_values[pos & m_mask] = value_type(std::move(args)...);
+                m_sequence[pos & m_mask].store(pos + 1u, std::memory_order_release);
+            }
+
+            impl_unpark();
+
+            return true;
+        }
+
+        // Queue an event, yielding while the queue is full
+        void push(Args... args)
+        {
+            while (!try_push(args...))
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        // Drain up to max queued events, invoking e once per contiguous batch
+        // returns the number of events drained
+        size_t drain(batch_event_type& e, size_t max = SIZE_MAX)
+        {
+            size_t drained = 0;
+
+            while (drained < max)
+            {
+                size_t head = m_head.load(std::memory_order_relaxed);
+                size_t n = impl_ready(head, max - drained);
+
+                if (n == 0)
+                {
+                    break;
+                }
+
+                e.invoke(pod_span<const value_type>(m_values.get() + (head & m_mask), n));
+
+                impl_release(head, n);
+                drained += n;
+            }
+
+            return drained;
+        }
+
+        // Drain up to max queued events, invoking e once per event
+        // returns the number of events drained
+        size_t drain_each(event_type& e, size_t max = SIZE_MAX)
+        {
+            size_t drained = 0;
+
+            while (drained < max)
+            {
+                size_t head = m_head.load(std::memory_order_relaxed);
+                size_t n = impl_ready(head, max - drained);
+
+                if (n == 0)
+                {
+                    break;
+                }
+
+                for (size_t i = 0; i != n; ++i)
+                {
+                    std::apply([&e](const Args&... args)
+                    {
+                        e.invoke(args...);
+                    }, m_values[(head + i) & m_mask]);
+                }
+
+                impl_release(head, n);
+                drained += n;
+            }
+
+            return drained;
+        }
+
+        // Park the consumer until an event is queued, wake() is called, or timeout passes
+        // returns true if an event is queued
+        template<class Rep, class Period>
+        bool wait(std::chrono::duration<Rep, Period> timeout)
+        {
+            if (!empty())
+            {
+                return true;
+            }
+
+            std::unique_lock<std::mutex> lock(m_park_mtx);
+
+            // Producers check m_parked after publishing, so either they see it,
+            // or this thread sees their event below
+            m_parked.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            m_park_cv.wait_for(lock, timeout, [this]()
+            {
+                return !empty() || m_woken;
+            });
+
+            m_parked.store(false, std::memory_order_relaxed);
+            m_woken = false;
+
+            return !empty();
+        }
+
+        // Wake a parked consumer, such as to shut it down
+        void wake()
+        {
+            std::lock_guard<std::mutex> lock(m_park_mtx);
+            m_woken = true;
+            m_park_cv.notify_one();
+        }
+
+        // True if no event is ready to drain
+        // only meaningful on the consumer thread
+        [[nodiscard]]
+        bool empty() const
+        {
+            return impl_ready(m_head.load(std::memory_order_relaxed), 1) == 0;
+        }
+
+        // Returns the maximum number of queued events
+        [[nodiscard]]
+        size_t capacity() const
+        {
+            return m_mask + 1u;
+        }
+
+    protected:
+
+        static constexpr size_t impl_cache_line = 64;
+
+        const size_t m_mask;
+        std::unique_ptr<value_type[]> m_values;
+
+        // Slot sequence numbers, for multiple producers
+        // slot i is free for position p when it holds p, and ready to drain when it holds p + 1
+        std::unique_ptr<std::atomic<size_t>[]> m_sequence;
+
+        // Consumer position, and the last producer position it saw
+        alignas(impl_cache_line) std::atomic<size_t> m_head;
+        mutable size_t m_cached_tail;
+
+        // Producer position, and the last consumer position it saw (single producer)
+        alignas(impl_cache_line) std::atomic<size_t> m_tail;
+        size_t m_cached_head;
+
+        // Consumer parking
+        alignas(impl_cache_line) std::atomic<bool> m_parked;
+        bool m_woken = false;
+        std::mutex m_park_mtx;
+        std::condition_variable m_park_cv;
+
+        static size_t impl_round_capacity(size_t capacity)
+        {
+            size_t n = 2;
+
+            while (n < capacity)
+            {
+                n <<= 1u;
+            }
+
+            return n;
+        }
+
+        // Returns the number of events ready at head, up to max, without wrapping
+        size_t impl_ready(size_t head, size_t max) const
+        {
+            size_t limit = m_mask + 1u - (head & m_mask);
+
+            if (max > limit)
+            {
+                max = limit;
+            }
+
+            if constexpr (Producers == single_producer)
+            {
+                if (m_cached_tail == head)
+                {
+                    m_cached_tail = m_tail.load(std::memory_order_acquire);
+                }
+
+                size_t n = m_cached_tail - head;
+
+                return (n < max) ? n : max;
+            }
+            else
+            {
+                size_t n = 0;
+
+                while (n != max && m_sequence[(head + n) & m_mask].load(std::memory_order_acquire) == head + n + 1u)
+                {
+                    ++n;
+                }
+
+                return n;
+            }
+        }
+
+        // Return n drained slots to the producers
+        void impl_release(size_t head, size_t n)
+        {
+            if constexpr (Producers == multiple_producers)
+            {
+                for (size_t i = 0; i != n; ++i)
+                {
+                    m_sequence[(head + i) & m_mask].store(head + i + m_mask + 1u, std::memory_order_release);
+                }
+            }
+
+            m_head.store(head + n, std::memory_order_release);
+        }
+
+        // Wake the consumer if it is parked
+        void impl_unpark()
+        {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            if (m_parked.load(std::memory_order_relaxed))
+            {
+                std::lock_guard<std::mutex> lock(m_park_mtx);
+                m_park_cv.notify_one();
+            }
+        }
+    };
+
+    // Single producer, single consumer event queue
+    template<class... Args>
+    using spsc_event_queue = event_queue<single_producer, Args...>;
+
+    // Multiple producer, single consumer event queue
+    template<class... Args>
+    using mpsc_event_queue = event_queue<multiple_producers, Args...>;
+}
+
+#endif
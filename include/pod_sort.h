@@ -0,0 +1,471 @@
+// k13
+// Kyle J Burgess
+
+#ifndef K13_POD_SORT_H
+#define K13_POD_SORT_H
+
+#include "pod_vector.h"
+#include "pod_span.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <functional>
+#include <cstring>
+#include <cstdint>
+#include <exception>
+#include <type_traits>
+#include <vector>
+
+namespace k13
+{
+    // Maps a key to an unsigned integer with the same ordering
+
+    template<class K, class = void>
+    struct radix_key_traits;
+
+    // Unsigned integers sort by their bits
+    template<class K>
+    struct radix_key_traits<K, typename std::enable_if<std::is_integral<K>::value && std::is_unsigned<K>::value>::type>
+    {
+        using bits_type = K;
+
+        static bits_type to_bits(K x)
+        {
+            return x;
+        }
+    };
+
+    // Signed integers sort by their bits with the sign bit flipped
+    template<class K>
+    struct radix_key_traits<K, typename std::enable_if<std::is_integral<K>::value && std::is_signed<K>::value>::type>
+    {
+        using bits_type = typename std::make_unsigned<K>::type;
+
+        static bits_type to_bits(K x)
+        {
+            return static_cast<bits_type>(x) ^ (bits_type(1) << (8 * sizeof(K) - 1));
+        }
+    };
+
+    // Floating point numbers flip all bits of negative values, and the sign bit of positive values
+    template<class K>
+    struct radix_key_traits<K, typename std::enable_if<std::is_floating_point<K>::value>::type>
+    {
+        static_assert(sizeof(K) == 4 || sizeof(K) == 8, "radix_key_traits unsupported floating point size");
+
+        using bits_type = typename std::conditional<sizeof(K) == 4, uint32_t, uint64_t>::type;
+
+        static bits_type to_bits(K x)
+        {
+            bits_type b;
+            memcpy(&b, &x, sizeof(K));
+
+            constexpr bits_type sign = bits_type(1) << (8 * sizeof(K) - 1);
+
+            return (b & sign)
+                ? ~b
+                : (b | sign);
+        }
+    };
+
+    // Runs f(i) for i in [0, n) as separate tasks on a thread pool,
+    // and waits for all of them
+    // every task references f, so all are waited on before the first exception is rethrown
+    template<class F>
+    void impl_parallel_for(thread_pool& pool, size_t n, const F& f)
+    {
+        std::vector<thread_task> tasks(n);
+        std::exception_ptr error;
+        size_t started = 0;
+
+        try
+        {
+            // A pool without threads runs each task, and throws, in run
+            for (; started != n; ++started)
+            {
+                pool.run(tasks[started], [&f, i = started]()
+                {
+                    f(i);
+                });
+            }
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+
+        for (size_t i = 0; i != started; ++i)
+        {
+            try
+            {
+                tasks[i].wait();
+            }
+            catch (...)
+            {
+                if (error == nullptr)
+                {
+                    error = std::current_exception();
+                }
+            }
+        }
+
+        if (error != nullptr)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+
+    // Number of blocks to split n elements into for a thread pool
+    inline size_t impl_parallel_blocks(const thread_pool& pool, size_t n, size_t min_block = 4096)
+    {
+        size_t blocks = (pool.size() > 0) ? pool.size() : 1;
+        size_t max_blocks = (n + min_block - 1) / min_block;
+
+        return (max_blocks < blocks)
+            ? ((max_blocks > 0) ? max_blocks : 1)
+            : blocks;
+    }
+
+    // LSD radix sort of n records by key(record)
+    // stable, uses n elements of scratch memory
+    template<class T, class KeyFn>
+    void radix_sort(T* data, size_t n, KeyFn key)
+    {
+        using key_type = typename std::decay<decltype(key(*data))>::type;
+        using traits = radix_key_traits<key_type>;
+        constexpr size_t passes = sizeof(typename traits::bits_type);
+
+        if (n < 2)
+        {
+            return;
+        }
+
+        // Digit counts do not depend on order, so count every pass at once
+        pod_vector<size_t> counts(passes * 256u, 0);
+
+        for (size_t i = 0; i != n; ++i)
+        {
+            auto bits = traits::to_bits(key(data[i]));
+
+            for (size_t p = 0; p != passes; ++p)
+            {
+                ++counts[p * 256u + ((bits >> (8u * p)) & 0xffu)];
+            }
+        }
+
+        pod_vector<T> scratch(n);
+        T* src = data;
+        T* dst = scratch.data();
+
+        for (size_t p = 0; p != passes; ++p)
+        {
+            size_t* count = counts.data() + p * 256u;
+
+            // Skip passes where every element has the same digit
+            if (count[(traits::to_bits(key(src[0])) >> (8u * p)) & 0xffu] == n)
+            {
+                continue;
+            }
+
+            size_t offset = 0;
+            for (size_t d = 0; d != 256u; ++d)
+            {
+                size_t c = count[d];
+                count[d] = offset;
+                offset += c;
+            }
+
+            for (size_t i = 0; i != n; ++i)
+            {
+                size_t d = (traits::to_bits(key(src[i])) >> (8u * p)) & 0xffu;
+                dst[count[d]++] = src[i];
+            }
+
+            std::swap(src, dst);
+        }
+
+        if (src != data)
+        {
+            memcpy(data, src, n * sizeof(T));
+        }
+    }
+
+    // LSD radix sort of n integer or floating point numbers
+    template<class T>
+    void radix_sort(T* data, size_t n)
+    {
+        static_assert(std::is_arithmetic<T>::value, "radix_sort without a key function requires an arithmetic type");
+        radix_sort(data, n, [](T x) { return x; });
+    }
+
+    // Parallel LSD radix sort of n records by key(record) on a thread pool
+    // stable, uses n elements of scratch memory
+    template<class T, class KeyFn>
+    void radix_sort(thread_pool& pool, T* data, size_t n, KeyFn key)
+    {
+        using key_type = typename std::decay<decltype(key(*data))>::type;
+        using traits = radix_key_traits<key_type>;
+        constexpr size_t passes = sizeof(typename traits::bits_type);
+
+        size_t blocks = impl_parallel_blocks(pool, n);
+
+        if (blocks < 2)
+        {
+            radix_sort(data, n, key);
+            return;
+        }
+
+        size_t block_size = (n + blocks - 1) / blocks;
+
+        pod_vector<T> scratch(n);
+        pod_vector<size_t> counts(blocks * 256u);
+        T* src = data;
+        T* dst = scratch.data();
+
+        for (size_t p = 0; p != passes; ++p)
+        {
+            size_t shift = 8u * p;
+
+            // Count digits per block
+            impl_parallel_for(pool, blocks, [&](size_t b)
+            {
+                size_t* count = counts.data() + b * 256u;
+                std::fill(count, count + 256u, size_t(0));
+
+                size_t end = std::min(n, (b + 1) * block_size);
+                for (size_t i = b * block_size; i < end; ++i)
+                {
+                    ++count[(traits::to_bits(key(src[i])) >> shift) & 0xffu];
+                }
+            });
+
+            // Skip passes where every element has the same digit
+            size_t first = (traits::to_bits(key(src[0])) >> shift) & 0xffu;
+            size_t same = 0;
+            for (size_t b = 0; b != blocks; ++b)
+            {
+                same += counts[b * 256u + first];
+            }
+
+            if (same == n)
+            {
+                continue;
+            }
+
+            // Each block writes its share of a digit after the earlier blocks' share
+            size_t offset = 0;
+            for (size_t d = 0; d != 256u; ++d)
+            {
+                for (size_t b = 0; b != blocks; ++b)
+                {
+                    size_t c = counts[b * 256u + d];
+                    counts[b * 256u + d] = offset;
+                    offset += c;
+                }
+            }
+
+            impl_parallel_for(pool, blocks, [&](size_t b)
+            {
+                size_t* count = counts.data() + b * 256u;
+
+                size_t end = std::min(n, (b + 1) * block_size);
+                for (size_t i = b * block_size; i < end; ++i)
+                {
+                    size_t d = (traits::to_bits(key(src[i])) >> shift) & 0xffu;
+                    dst[count[d]++] = src[i];
+                }
+            });
+
+            std::swap(src, dst);
+        }
+
+        if (src != data)
+        {
+            impl_parallel_for(pool, blocks, [&](size_t b)
+            {
+                size_t begin = b * block_size;
+                size_t end = std::min(n, begin + block_size);
+
+                if (begin < end)
+                {
+                    memcpy(data + begin, src + begin, (end - begin) * sizeof(T));
+                }
+            });
+        }
+    }
+
+    // Parallel LSD radix sort of n integer or floating point numbers on a thread pool
+    template<class T>
+    void radix_sort(thread_pool& pool, T* data, size_t n)
+    {
+        static_assert(std::is_arithmetic<T>::value, "radix_sort without a key function requires an arithmetic type");
+        radix_sort(pool, data, n, [](T x) { return x; });
+    }
+
+    // Merges k sorted runs into out, which must hold the sum of the run sizes
+    // stable, equal elements are taken from earlier runs first
+    template<class T, class Compare = std::less<T>>
+    void kway_merge(const pod_span<const T>* runs, size_t k, T* out, Compare comp = Compare())
+    {
+        std::vector<size_t> pos(k, 0);
+        std::vector<size_t> heap;
+        heap.reserve(k);
+
+        // Heap of run indices, ordered by each run's next element
+        auto greater = [&](size_t a, size_t b)
+        {
+            const T& x = runs[a][pos[a]];
+            const T& y = runs[b][pos[b]];
+
+            if (comp(y, x))
+            {
+                return true;
+            }
+
+            return !comp(x, y) && b < a;
+        };
+
+        for (size_t r = 0; r != k; ++r)
+        {
+            if (!runs[r].empty())
+            {
+                heap.push_back(r);
+            }
+        }
+
+        std::make_heap(heap.begin(), heap.end(), greater);
+
+        while (!heap.empty())
+        {
+            std::pop_heap(heap.begin(), heap.end(), greater);
+            size_t r = heap.back();
+
+            *out++ = runs[r][pos[r]++];
+
+            if (pos[r] == runs[r].size())
+            {
+                heap.pop_back();
+            }
+            else
+            {
+                std::push_heap(heap.begin(), heap.end(), greater);
+            }
+        }
+    }
+
+    // Parallel comparison sort on a thread pool
+    // blocks are sorted concurrently, then k-way merged
+    template<class T, class Compare = std::less<T>>
+    void parallel_sort(thread_pool& pool, T* data, size_t n, Compare comp = Compare())
+    {
+        size_t blocks = impl_parallel_blocks(pool, n);
+
+        if (blocks < 2)
+        {
+            std::sort(data, data + n, comp);
+            return;
+        }
+
+        size_t block_size = (n + blocks - 1) / blocks;
+        std::vector<pod_span<const T>> runs(blocks);
+
+        impl_parallel_for(pool, blocks, [&](size_t b)
+        {
+            size_t begin = std::min(n, b * block_size);
+            size_t end = std::min(n, begin + block_size);
+
+            std::sort(data + begin, data + end, comp);
+            runs[b] = pod_span<const T>(data + begin, end - begin);
+        });
+
+        pod_vector<T> scratch(n);
+        kway_merge(runs.data(), blocks, scratch.data(), comp);
+        memcpy(data, scratch.data(), n * sizeof(T));
+    }
+
+    // Stable partition on a thread pool
+    // elements satisfying pred are moved before those that do not, keeping their order
+    // returns the number of elements satisfying pred
+    template<class T, class Predicate>
+    size_t stable_partition(thread_pool& pool, T* data, size_t n, Predicate pred)
+    {
+        size_t blocks = impl_parallel_blocks(pool, n);
+        size_t block_size = (n + blocks - 1) / blocks;
+
+        // Count the matches in each block
+        pod_vector<size_t> matches(blocks);
+
+        impl_parallel_for(pool, blocks, [&](size_t b)
+        {
+            size_t count = 0;
+            size_t end = std::min(n, (b + 1) * block_size);
+
+            for (size_t i = b * block_size; i < end; ++i)
+            {
+                count += pred(data[i]) ? 1u : 0u;
+            }
+
+            matches[b] = count;
+        });
+
+        size_t total = 0;
+        for (size_t b = 0; b != blocks; ++b)
+        {
+            total += matches[b];
+        }
+
+        // Scatter each block after the earlier blocks' matches and non-matches
+        pod_vector<T> scratch(n);
+        size_t true_offset = 0;
+        size_t false_offset = total;
+
+        pod_vector<size_t> true_offsets(blocks);
+        pod_vector<size_t> false_offsets(blocks);
+
+        for (size_t b = 0; b != blocks; ++b)
+        {
+            size_t begin = std::min(n, b * block_size);
+            size_t end = std::min(n, begin + block_size);
+
+            true_offsets[b] = true_offset;
+            false_offsets[b] = false_offset;
+
+            true_offset += matches[b];
+            false_offset += (end - begin) - matches[b];
+        }
+
+        impl_parallel_for(pool, blocks, [&](size_t b)
+        {
+            T* t = scratch.data() + true_offsets[b];
+            T* f = scratch.data() + false_offsets[b];
+            size_t end = std::min(n, (b + 1) * block_size);
+
+            for (size_t i = b * block_size; i < end; ++i)
+            {
+                if (pred(data[i]))
+                {
+                    *t++ = data[i];
+                }
+                else
+                {
+                    *f++ = data[i];
+                }
+            }
+        });
+
+        impl_parallel_for(pool, blocks, [&](size_t b)
+        {
+            size_t begin = std::min(n, b * block_size);
+            size_t end = std::min(n, begin + block_size);
+
+            if (begin < end)
+            {
+                memcpy(data + begin, scratch.data() + begin, (end - begin) * sizeof(T));
+            }
+        });
+
+        return total;
+    }
+}
+
+#endif
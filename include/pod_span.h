@@ -0,0 +1,138 @@
+// k13
+// Kyle J Burgess
+
+#ifndef K13_POD_SPAN_H
+#define K13_POD_SPAN_H
+
+#include "basic_iterator.h"
+#include "basic_reverse_iterator.h"
+#include "pod_vector.h"
+
+#include <cstddef>
+#include <cassert>
+#include <type_traits>
+
+namespace k13
+{
+    // A non-owning view over a contiguous array of elements
+    // The viewed memory must outlive the span
+
+    template<class T>
+    class pod_span
+    {
+    public:
+
+        using iterator = basic_iterator<T>;
+        using reverse_iterator = basic_reverse_iterator<T>;
+
+        // Constructor
+        pod_span() : m_data(nullptr), m_size(0)
+        {}
+
+        // Constructor
+        pod_span(T* data, size_t size) : m_data(data), m_size(size)
+        {}
+
+        // Construct a span over a pod_vector
+        pod_span(pod_vector<std::remove_const_t<T>>& v) : m_data(v.data()), m_size(v.size())
+        {}
+
+        // Construct a const span over a const pod_vector
+        template<class U = T, class = typename std::enable_if<std::is_const<U>::value>::type>
+        pod_span(const pod_vector<std::remove_const_t<T>>& v) : m_data(v.data()), m_size(v.size())
+        {}
+
+        // Construct a const span from a non-const span
+        template<class U, class = typename std::enable_if<std::is_same<const U, T>::value>::type>
+        pod_span(const pod_span<U>& o) : m_data(o.data()), m_size(o.size())
+        {}
+
+        // Returns value at i
+        template<class U>
+        T& operator[](U i) const
+        {
+            assert(static_cast<size_t>(i) < m_size);
+            return m_data[i];
+        }
+
+        // Returns value at i
+        template<class U>
+        T& at(U i) const
+        {
+            assert(static_cast<size_t>(i) < m_size);
+            return m_data[i];
+        }
+
+        // Returns a view of n elements starting at element i
+        [[nodiscard]]
+        pod_span subspan(size_t i, size_t n) const
+        {
+            assert(i + n <= m_size);
+            return pod_span(m_data + i, n);
+        }
+
+        // Returns true if the span is empty (size = 0)
+        [[nodiscard]]
+        bool empty() const
+        {
+            return m_size == 0u;
+        }
+
+        // Returns the number of elements in the span
+        [[nodiscard]]
+        size_t size() const
+        {
+            return m_size;
+        }
+
+        // Returns pointer to data
+        T* data() const
+        {
+            return m_data;
+        }
+
+        // Returns iterator to the beginning of the data
+        iterator begin() const
+        {
+            return iterator(m_data);
+        }
+
+        // Returns iterator to the end of the data
+        iterator end() const
+        {
+            return iterator(m_data + m_size);
+        }
+
+        // Returns iterator to the reverse beginning of the data
+        reverse_iterator rbegin() const
+        {
+            return reverse_iterator(m_data + m_size - 1);
+        }
+
+        // Returns iterator to the reverse end of the data
+        reverse_iterator rend() const
+        {
+            return reverse_iterator(m_data - 1);
+        }
+
+        // Returns reference to the first element
+        T& front() const
+        {
+            assert(m_size > 0u);
+            return m_data[0];
+        }
+
+        // Returns reference to the last element
+        T& back() const
+        {
+            assert(m_size > 0u);
+            return m_data[m_size - 1u];
+        }
+
+    protected:
+        T* m_data;
+        size_t m_size;
+    };
+}
+
+#endif
@@ -10,14 +10,21 @@
 #include <cstring>
 #include <cstdint>
 #include <cassert>
+#include <new>
 #include <type_traits>
 
 namespace k13
 {
+    template<class T>
+    class shared_pod_vector;
+
     // A vector class optimized for POD types
     // Resizing does not initialize memory
+    // T only needs to be trivially copyable, since elements are moved and copied with memcpy
+    // Align sets the alignment of the buffer, for example to the width of simd loads,
+    // and 0 keeps the alignment of T
 
-    template<class T>
+    template<class T, size_t Align = 0>
     class pod_vector
     {
     public:
@@ -30,28 +37,29 @@ namespace k13
         // Constructor
         pod_vector() : m_data(nullptr), m_size(0), m_capacity(0)
         {
-            static_assert(std::is_pod<T>::value, "pod_vector template type T must be a POD type");
+            static_assert(std::is_trivially_copyable<T>::value, "pod_vector template type T must be trivially copyable");
+            static_assert(Align == 0 || (Align >= alignof(T) && (Align & (Align - 1u)) == 0), "pod_vector alignment must be 0, or a power of two of at least alignof(T)");
         }
 
         // Constructor
         pod_vector(size_t size) : m_data(nullptr), m_size(size), m_capacity(size)
         {
-            static_assert(std::is_pod<T>::value, "pod_vector template type T must be a POD type");
+            static_assert(std::is_trivially_copyable<T>::value, "pod_vector template type T must be trivially copyable");
             
             if (size > 0u)
             {
-                m_data = new T[size];
+                m_data = impl_allocate(size);
             }
         }
 
         // Constructor
         pod_vector(size_t size, T value) : m_data(nullptr), m_size(size), m_capacity(size)
         {
-            static_assert(std::is_pod<T>::value, "pod_vector template type T must be a POD type");
+            static_assert(std::is_trivially_copyable<T>::value, "pod_vector template type T must be trivially copyable");
             
             if (size > 0u)
             {
-                m_data = new T[size];
+                m_data = impl_allocate(size);
                 impl_fill(value);
             }
         }
@@ -61,7 +69,7 @@ namespace k13
         {
             if (m_size > 0)
             {
-                m_data = new T[m_capacity];
+                m_data = impl_allocate(m_capacity);
                 memcpy(m_data, o.m_data, m_size * sizeof(T));
             }
         }
@@ -82,14 +90,14 @@ namespace k13
                 return *this;
             }
 
-            delete[] m_data;
+            impl_free(m_data);
             m_data = nullptr;
             m_size = o.m_size;
             m_capacity = o.m_size;
 
             if (m_size > 0)
             {
-                m_data = new T[m_capacity];
+                m_data = impl_allocate(m_capacity);
                 memcpy(m_data, o.m_data, m_size * sizeof(T));
             }
 
@@ -101,7 +109,7 @@ namespace k13
         {
             if (this != &o)
             {
-                delete[] m_data;
+                impl_free(m_data);
 
                 m_data = o.m_data;
                 m_size = o.m_size;
@@ -118,7 +126,7 @@ namespace k13
         // Destructor
         ~pod_vector()
         {
-            delete[] m_data;
+            impl_free(m_data);
         }
 
         // Returns const value at i
@@ -368,19 +376,47 @@ namespace k13
         }
 
     protected:
+        friend class shared_pod_vector<T>;
+
         T* m_data;
         size_t m_size;
         size_t m_capacity;
 
+        // Allocates n uninitialized elements, aligned to Align
+        static T* impl_allocate(size_t n)
+        {
+            if constexpr (Align == 0)
+            {
+                return new T[n];
+            }
+            else
+            {
+                return static_cast<T*>(::operator new[](n * sizeof(T), std::align_val_t(Align)));
+            }
+        }
+
+        // Frees elements allocated by impl_allocate
+        static void impl_free(T* data)
+        {
+            if constexpr (Align == 0)
+            {
+                delete[] data;
+            }
+            else
+            {
+                ::operator delete[](data, std::align_val_t(Align));
+            }
+        }
+
         void impl_set_capacity(size_t n)
         {
             assert(n >= m_size);
-            T* data = new T[n];
+            T* data = impl_allocate(n);
             if (m_size > 0)
             {
                 memcpy(data, m_data, m_size * sizeof(T));
-                delete[] m_data;
             }
+            impl_free(m_data);
             m_data = data;
             m_capacity = n;
         }
@@ -4,7 +4,12 @@
 #ifndef K13_SCALAR_H
 #define K13_SCALAR_H
 
+#include "pod_vector.h"
+
+#include <charconv>
 #include <string>
+#include <string_view>
+#include <optional>
 #include <cstdint>
 #include <type_traits>
 #include <stdexcept>
@@ -19,6 +24,8 @@
 
 namespace k13
 {
+    struct scalar_parse_result;
+
     // scalar_t
     // Stores a number as an int64 if assigned with an integer,
     // or a double if assigned with a floating point number.
@@ -105,9 +112,43 @@ namespace k13
 
         scalar_t& operator/=(const scalar_t& x);
 
-        // Convert value into a string
+        // Characters in the longest shortest-form value, -2.2250738585072014e-308
+        static constexpr size_t max_chars = 24;
+
+        // Convert value into a string, in the shortest form that parses back to the same value
+        // reals with integer values are written without a point, as with iostreams
+        [[nodiscard]]
+        std::string to_string() const;
+
+        // Convert value into a string, with reals rounded to precision significant digits
+        [[nodiscard]]
+        std::string to_string(int precision) const;
+
+        // Write value into [first, last), in the shortest form that parses back to the same value
+        // returns the end of the characters written, or last with std::errc::value_too_large
+        // if they do not fit, which cannot happen with max_chars of space
+        std::to_chars_result to_chars(char* first, char* last) const;
+
+        // Write value into [first, last), with reals rounded to precision significant digits
+        std::to_chars_result to_chars(char* first, char* last, int precision) const;
+
+        // Append value to buffer, in the shortest form that parses back to the same value
+        void append_chars(pod_vector<char>& buffer) const;
+
+        // Append n values to buffer, separated by delimiter
+        static void append_chars(const scalar_t* values, size_t n, char delimiter, pod_vector<char>& buffer);
+
+        // Parse a number, ignoring surrounding spaces and tabs
+        // integers are stored as int64, and numbers with a fraction or exponent,
+        // infinities, nans, and integers beyond int64 as double
+        // returns nothing if s is not a number
         [[nodiscard]]
-        std::string to_string(int precision = 17) const;
+        static std::optional<scalar_t> parse(std::string_view s);
+
+        // Parse numbers separated by delimiter or line breaks, appending them to values
+        // blank lines are skipped and spaces and tabs around numbers are ignored
+        // stops at the first field that is not a number, and reports its offset
+        static scalar_parse_result parse(std::string_view text, char delimiter, pod_vector<scalar_t>& values);
 
         // True if the underlying value is a floating point number
         [[nodiscard]]
@@ -199,6 +240,26 @@ namespace k13
             real_t real_val;
         } m_data;
 
+        // Parse a number at the start of [first, last)
+        // returns the end of the number, or first if there is none
+        static const char* impl_parse(const char* first, const char* last, scalar_t& x);
+    };
+
+    // Result of parsing delimited numbers
+    struct scalar_parse_result
+    {
+        // Numbers appended
+        size_t count = 0;
+
+        // Offset of the first field that is not a number, or npos if every field parsed
+        size_t error = std::string_view::npos;
+
+        // True if every field parsed
+        [[nodiscard]]
+        bool ok() const
+        {
+            return error == std::string_view::npos;
+        }
     };
 
     // STL stream integration
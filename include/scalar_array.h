@@ -0,0 +1,513 @@
+// k13
+// Kyle J Burgess
+
+#ifndef K13_SCALAR_ARRAY_H
+#define K13_SCALAR_ARRAY_H
+
+#include "bytes.h"
+#include "pod_vector.h"
+#include "scalar.h"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+namespace k13
+{
+    // Scalar Array
+    // A column of scalar_t, stored as one 8 byte payload per element and a packed bitset
+    // of their types, so it takes about half the memory of a pod_vector<scalar_t>
+    // Elementwise math and comparisons follow the promotion rules of scalar_t: an element
+    // is computed as a real if either operand is real, and as an integer otherwise
+    // Each run of 64 elements whose types match in both columns is computed as a plain
+    // loop over the payloads that the compiler can vectorize, without checking types
+    // per element, so all integer and all real columns never branch on type
+    class scalar_array
+    {
+    public:
+
+        // Constructor
+        scalar_array()
+            : m_real_count(0)
+        {}
+
+        // Construct n integer zeros
+        explicit scalar_array(size_t n)
+            : m_data(n, 0)
+            , m_tags(impl_words(n), 0)
+            , m_real_count(0)
+        {}
+
+        // Construct from n scalars
+        scalar_array(const scalar_t* values, size_t n)
+            : scalar_array(n)
+        {
+            for (size_t i = 0; i != n; ++i)
+            {
+                set(i, values[i]);
+            }
+        }
+
+        // Construct from n integers
+        scalar_array(const int64_t* values, size_t n)
+            : scalar_array(n)
+        {
+            for (size_t i = 0; i != n; ++i)
+            {
+                m_data[i] = impl_from_int(values[i]);
+            }
+        }
+
+        // Construct from n reals
+        scalar_array(const double* values, size_t n)
+            : scalar_array(n)
+        {
+            for (size_t i = 0; i != n; ++i)
+            {
+                m_data[i] = impl_from_real(values[i]);
+            }
+
+            impl_set_all_real();
+        }
+
+        // Returns the number of elements
+        [[nodiscard]]
+        size_t size() const
+        {
+            return m_data.size();
+        }
+
+        // True if there are no elements
+        [[nodiscard]]
+        bool empty() const
+        {
+            return m_data.empty();
+        }
+
+        // Reserve space for n elements
+        void reserve(size_t n)
+        {
+            m_data.reserve(n);
+            m_tags.reserve(impl_words(n));
+        }
+
+        // Resize to n elements, new elements are integer zeros
+        void resize(size_t n)
+        {
+            size_t size = m_data.size();
+
+            // Drop the types of removed elements, so unused tag bits stay clear
+            for (size_t i = n; i < size; ++i)
+            {
+                impl_set_real(i, false);
+            }
+
+            m_data.resize(n, 0);
+            m_tags.resize(impl_words(n), 0);
+        }
+
+        // Remove every element
+        void clear()
+        {
+            m_data.clear();
+            m_tags.clear();
+            m_real_count = 0;
+        }
+
+        // Append x
+        void push_back(const scalar_t& x)
+        {
+            size_t i = m_data.size();
+
+            m_data.push_back(0);
+
+            if (impl_words(i + 1u) != m_tags.size())
+            {
+                m_tags.push_back(0);
+            }
+
+            set(i, x);
+        }
+
+        // Returns element i
+        [[nodiscard]]
+        scalar_t operator[](size_t i) const
+        {
+            assert(i < size());
+
+            if (is_real(i))
+            {
+                return impl_to_real(m_data[i]);
+            }
+
+            return impl_to_int(m_data[i]);
+        }
+
+        // Sets element i to x
+        void set(size_t i, const scalar_t& x)
+        {
+            assert(i < size());
+
+            if (x.is_floating_point())
+            {
+                m_data[i] = impl_from_real(static_cast<double>(x));
+                impl_set_real(i, true);
+            }
+            else
+            {
+                m_data[i] = impl_from_int(static_cast<int64_t>(x));
+                impl_set_real(i, false);
+            }
+        }
+
+        // True if element i is a real
+        [[nodiscard]]
+        bool is_real(size_t i) const
+        {
+            return (m_tags[i / 64u] >> (i % 64u)) & 1u;
+        }
+
+        // True if element i is an integer
+        [[nodiscard]]
+        bool is_integer(size_t i) const
+        {
+            return !is_real(i);
+        }
+
+        // True if every element is an integer
+        [[nodiscard]]
+        bool all_integer() const
+        {
+            return m_real_count == 0;
+        }
+
+        // True if every element is a real
+        [[nodiscard]]
+        bool all_real() const
+        {
+            return m_real_count == size();
+        }
+
+        // Returns the number of real elements
+        [[nodiscard]]
+        size_t real_count() const
+        {
+            return m_real_count;
+        }
+
+        // Returns the elements as scalars
+        [[nodiscard]]
+        pod_vector<scalar_t> to_vector() const
+        {
+            pod_vector<scalar_t> v(size());
+
+            for (size_t i = 0; i != size(); ++i)
+            {
+                v[i] = operator[](i);
+            }
+
+            return v;
+        }
+
+        // Elementwise math, the columns must be the same size
+        [[nodiscard]]
+        scalar_array operator+(const scalar_array& x) const
+        {
+            return impl_math(x,
+                [](int64_t a, int64_t b) { return a + b; },
+                [](double a, double b) { return a + b; });
+        }
+
+        [[nodiscard]]
+        scalar_array operator-(const scalar_array& x) const
+        {
+            return impl_math(x,
+                [](int64_t a, int64_t b) { return a - b; },
+                [](double a, double b) { return a - b; });
+        }
+
+        [[nodiscard]]
+        scalar_array operator*(const scalar_array& x) const
+        {
+            return impl_math(x,
+                [](int64_t a, int64_t b) { return a * b; },
+                [](double a, double b) { return a * b; });
+        }
+
+        // Integer elements divide as integers, as with scalar_t
+        [[nodiscard]]
+        scalar_array operator/(const scalar_array& x) const
+        {
+            return impl_math(x,
+                [](int64_t a, int64_t b) { return a / b; },
+                [](double a, double b) { return a / b; });
+        }
+
+        scalar_array& operator+=(const scalar_array& x)
+        {
+            return *this = *this + x;
+        }
+
+        scalar_array& operator-=(const scalar_array& x)
+        {
+            return *this = *this - x;
+        }
+
+        scalar_array& operator*=(const scalar_array& x)
+        {
+            return *this = *this * x;
+        }
+
+        scalar_array& operator/=(const scalar_array& x)
+        {
+            return *this = *this / x;
+        }
+
+        // Elementwise comparison, the columns must be the same size
+        // returns 1 for each element where the comparison holds, and 0 elsewhere
+        [[nodiscard]]
+        pod_vector<uint8_t> operator==(const scalar_array& x) const
+        {
+            return impl_compare(x,
+                [](int64_t a, int64_t b) { return a == b; },
+                [](double a, double b) { return a == b; });
+        }
+
+        [[nodiscard]]
+        pod_vector<uint8_t> operator!=(const scalar_array& x) const
+        {
+            return impl_compare(x,
+                [](int64_t a, int64_t b) { return a != b; },
+                [](double a, double b) { return a != b; });
+        }
+
+        [[nodiscard]]
+        pod_vector<uint8_t> operator<(const scalar_array& x) const
+        {
+            return impl_compare(x,
+                [](int64_t a, int64_t b) { return a < b; },
+                [](double a, double b) { return a < b; });
+        }
+
+        [[nodiscard]]
+        pod_vector<uint8_t> operator>(const scalar_array& x) const
+        {
+            return impl_compare(x,
+                [](int64_t a, int64_t b) { return a > b; },
+                [](double a, double b) { return a > b; });
+        }
+
+        // Not greater, as scalar_t defines it, so a NaN element compares true
+        [[nodiscard]]
+        pod_vector<uint8_t> operator<=(const scalar_array& x) const
+        {
+            return impl_compare(x,
+                [](int64_t a, int64_t b) { return a <= b; },
+                [](double a, double b) { return !(a > b); });
+        }
+
+        // Not less, as scalar_t defines it, so a NaN element compares true
+        [[nodiscard]]
+        pod_vector<uint8_t> operator>=(const scalar_array& x) const
+        {
+            return impl_compare(x,
+                [](int64_t a, int64_t b) { return a >= b; },
+                [](double a, double b) { return !(a < b); });
+        }
+
+    protected:
+
+        // Payloads, the bits of an int64 or a double
+        pod_vector<uint64_t> m_data;
+
+        // Type bits, set for reals, clear past the last element
+        pod_vector<uint64_t> m_tags;
+
+        size_t m_real_count;
+
+        static size_t impl_words(size_t n)
+        {
+            return (n + 63u) / 64u;
+        }
+
+        K13_INLINE_ATTRIBUTE
+        static uint64_t impl_from_int(int64_t x)
+        {
+            return static_cast<uint64_t>(x);
+        }
+
+        K13_INLINE_ATTRIBUTE
+        static uint64_t impl_from_real(double x)
+        {
+            return impl_bit_cast<uint64_t>(x);
+        }
+
+        K13_INLINE_ATTRIBUTE
+        static int64_t impl_to_int(uint64_t x)
+        {
+            return static_cast<int64_t>(x);
+        }
+
+        K13_INLINE_ATTRIBUTE
+        static double impl_to_real(uint64_t x)
+        {
+            return impl_bit_cast<double>(x);
+        }
+
+        // Element i as a real, converting an integer
+        double impl_as_real(size_t i) const
+        {
+            return is_real(i) ? impl_to_real(m_data[i]) : static_cast<double>(impl_to_int(m_data[i]));
+        }
+
+        void impl_set_real(size_t i, bool real)
+        {
+            uint64_t bit = uint64_t(1) << (i % 64u);
+            uint64_t& word = m_tags[i / 64u];
+
+            if (real != ((word & bit) != 0))
+            {
+                word ^= bit;
+                m_real_count = real ? (m_real_count + 1u) : (m_real_count - 1u);
+            }
+        }
+
+        void impl_set_all_real()
+        {
+            size_t n = size();
+
+            for (size_t w = 0; w != m_tags.size(); ++w)
+            {
+                m_tags[w] = ~uint64_t(0);
+            }
+
+            if (n % 64u != 0)
+            {
+                m_tags[n / 64u] = (uint64_t(1) << (n % 64u)) - 1u;
+            }
+
+            m_real_count = n;
+        }
+
+        // Mask of the elements of tag word w that are in the array
+        uint64_t impl_word_mask(size_t w) const
+        {
+            size_t n = size() - w * 64u;
+
+            return (n < 64u)
+                ? ((uint64_t(1) << n) - 1u)
+                : ~uint64_t(0);
+        }
+
+        // Runs the elements of each tag word as integers if both words are clear,
+        // as reals if both words are full, and checks each element otherwise
+        template<class IntOp, class RealOp>
+        scalar_array impl_math(const scalar_array& x, IntOp int_op, RealOp real_op) const
+        {
+            assert(size() == x.size());
+
+            size_t n = size();
+
+            scalar_array r;
+            r.m_data.resize(n);
+            r.m_tags.resize(m_tags.size());
+
+            const uint64_t* a = m_data.data();
+            const uint64_t* b = x.m_data.data();
+            uint64_t* c = r.m_data.data();
+
+            for (size_t w = 0; w != m_tags.size(); ++w)
+            {
+                uint64_t ta = m_tags[w];
+                uint64_t tb = x.m_tags[w];
+                uint64_t tc = ta | tb;
+
+                // An element is real if either operand is
+                r.m_tags[w] = tc;
+                r.m_real_count += static_cast<size_t>(impl_popcount(tc));
+
+                size_t first = w * 64u;
+                size_t last = (n - first < 64u) ? n : (first + 64u);
+
+                if (tc == 0)
+                {
+                    for (size_t i = first; i != last; ++i)
+                    {
+                        c[i] = impl_from_int(int_op(impl_to_int(a[i]), impl_to_int(b[i])));
+                    }
+                }
+                else if ((ta & tb) == impl_word_mask(w))
+                {
+                    for (size_t i = first; i != last; ++i)
+                    {
+                        c[i] = impl_from_real(real_op(impl_to_real(a[i]), impl_to_real(b[i])));
+                    }
+                }
+                else
+                {
+                    for (size_t i = first; i != last; ++i)
+                    {
+                        c[i] = ((tc >> (i - first)) & 1u)
+                            ? impl_from_real(real_op(impl_as_real(i), x.impl_as_real(i)))
+                            : impl_from_int(int_op(impl_to_int(a[i]), impl_to_int(b[i])));
+                    }
+                }
+            }
+
+            return r;
+        }
+
+        // Same as impl_math, writing 1 or 0 for each element
+        template<class IntOp, class RealOp>
+        pod_vector<uint8_t> impl_compare(const scalar_array& x, IntOp int_op, RealOp real_op) const
+        {
+            assert(size() == x.size());
+
+            size_t n = size();
+
+            pod_vector<uint8_t> r(n);
+
+            const uint64_t* a = m_data.data();
+            const uint64_t* b = x.m_data.data();
+            uint8_t* c = r.data();
+
+            for (size_t w = 0; w != m_tags.size(); ++w)
+            {
+                uint64_t ta = m_tags[w];
+                uint64_t tb = x.m_tags[w];
+                uint64_t tc = ta | tb;
+
+                size_t first = w * 64u;
+                size_t last = (n - first < 64u) ? n : (first + 64u);
+
+                if (tc == 0)
+                {
+                    for (size_t i = first; i != last; ++i)
+                    {
+                        c[i] = static_cast<uint8_t>(int_op(impl_to_int(a[i]), impl_to_int(b[i])));
+                    }
+                }
+                else if ((ta & tb) == impl_word_mask(w))
+                {
+                    for (size_t i = first; i != last; ++i)
+                    {
+                        c[i] = static_cast<uint8_t>(real_op(impl_to_real(a[i]), impl_to_real(b[i])));
+                    }
+                }
+                else
+                {
+                    for (size_t i = first; i != last; ++i)
+                    {
+                        c[i] = ((tc >> (i - first)) & 1u)
+                            ? static_cast<uint8_t>(real_op(impl_as_real(i), x.impl_as_real(i)))
+                            : static_cast<uint8_t>(int_op(impl_to_int(a[i]), impl_to_int(b[i])));
+                    }
+                }
+            }
+
+            return r;
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,501 @@
+// k13
+// Kyle J Burgess
+
+#ifndef K13_SEGMENTED_POD_VECTOR_H
+#define K13_SEGMENTED_POD_VECTOR_H
+
+#include "pod_vector.h"
+#include "pod_span.h"
+
+#include <cstring>
+#include <cstdint>
+#include <cassert>
+#include <iterator>
+#include <type_traits>
+
+namespace k13
+{
+    // Random access iterator over the elements of a segmented_pod_vector
+
+    template<class T, size_t ChunkShift>
+    class segmented_iterator
+    {
+    public:
+
+        // Type Traits
+        using difference_type = std::ptrdiff_t;
+        using value_type = std::remove_const_t<T>;
+        using pointer = T*;
+        using reference = T&;
+        using iterator_category = std::random_access_iterator_tag;
+
+        // Constructor
+        explicit segmented_iterator(T* const* chunks = nullptr, size_t i = 0)
+            : m_chunks(chunks)
+            , m_i(i)
+        {}
+
+        // Pre-increment Operator
+        segmented_iterator& operator++()
+        {
+            ++m_i;
+            return *this;
+        }
+
+        // Post-increment Operator
+        segmented_iterator operator++(int)
+        {
+            const auto r = *this;
+            ++m_i;
+            return r;
+        }
+
+        // Pre-decrement Operator
+        segmented_iterator& operator--()
+        {
+            --m_i;
+            return *this;
+        }
+
+        // Post-decrement Operator
+        segmented_iterator operator--(int)
+        {
+            const auto r = *this;
+            --m_i;
+            return r;
+        }
+
+        // Addition Operator
+        [[nodiscard]]
+        segmented_iterator operator+(difference_type d) const
+        {
+            return segmented_iterator(m_chunks, m_i + d);
+        }
+
+        // Subtraction Operator
+        [[nodiscard]]
+        segmented_iterator operator-(difference_type d) const
+        {
+            return segmented_iterator(m_chunks, m_i - d);
+        }
+
+        // Subtraction Operator
+        [[nodiscard]]
+        difference_type operator-(const segmented_iterator& o) const
+        {
+            return static_cast<difference_type>(m_i) - static_cast<difference_type>(o.m_i);
+        }
+
+        // Increment Operator
+        segmented_iterator& operator+=(difference_type d)
+        {
+            m_i += d;
+            return *this;
+        }
+
+        // Decrement Operator
+        segmented_iterator& operator-=(difference_type d)
+        {
+            m_i -= d;
+            return *this;
+        }
+
+        // Equality Operator
+        [[nodiscard]]
+        bool operator==(const segmented_iterator& o) const
+        {
+            return m_i == o.m_i;
+        }
+
+        // Inequality Operator
+        [[nodiscard]]
+        bool operator!=(const segmented_iterator& o) const
+        {
+            return m_i != o.m_i;
+        }
+
+        // Pointer Operator
+        [[nodiscard]]
+        T& operator*() const
+        {
+            return m_chunks[m_i >> ChunkShift][m_i & ((size_t(1) << ChunkShift) - 1u)];
+        }
+
+        // Member Access Operator
+        [[nodiscard]]
+        T* operator->() const
+        {
+            return &operator*();
+        }
+
+    protected:
+        T* const* m_chunks;
+        size_t m_i;
+    };
+
+    // A vector class optimized for POD types, stored in fixed-size chunks
+    // of 2^ChunkShift elements
+    // Growing never moves existing elements, so pointers and references
+    // stay valid until the element is removed
+    // Resizing does not initialize memory
+
+    template<class T, size_t ChunkShift = 12>
+    class segmented_pod_vector
+    {
+    public:
+
+        static_assert(ChunkShift < 8 * sizeof(size_t), "segmented_pod_vector ChunkShift is too large");
+
+        using iterator = segmented_iterator<T, ChunkShift>;
+        using const_iterator = segmented_iterator<const T, ChunkShift>;
+
+        // Number of elements in each chunk
+        static constexpr size_t chunk_size = size_t(1) << ChunkShift;
+
+        // Constructor
+        segmented_pod_vector() : m_chunks(), m_size(0)
+        {
+            static_assert(std::is_pod<T>::value, "segmented_pod_vector template type T must be a POD type");
+        }
+
+        // Constructor
+        segmented_pod_vector(size_t size) : m_chunks(), m_size(0)
+        {
+            static_assert(std::is_pod<T>::value, "segmented_pod_vector template type T must be a POD type");
+            resize(size);
+        }
+
+        // Constructor
+        segmented_pod_vector(size_t size, T value) : m_chunks(), m_size(0)
+        {
+            static_assert(std::is_pod<T>::value, "segmented_pod_vector template type T must be a POD type");
+            resize(size, value);
+        }
+
+        // Copy Constructor
+        segmented_pod_vector(const segmented_pod_vector& o) : m_chunks(), m_size(0)
+        {
+            impl_copy(o);
+        }
+
+        // Move Constructor
+        segmented_pod_vector(segmented_pod_vector&& o) noexcept : m_chunks(std::move(o.m_chunks)), m_size(o.m_size)
+        {
+            o.m_size = 0;
+        }
+
+        // Copy-Assignment Operator
+        segmented_pod_vector& operator=(const segmented_pod_vector& o)
+        {
+            if (this != &o)
+            {
+                m_size = 0;
+                impl_copy(o);
+            }
+
+            return *this;
+        }
+
+        // Move-Assignment Operator
+        segmented_pod_vector& operator=(segmented_pod_vector&& o) noexcept
+        {
+            if (this != &o)
+            {
+                impl_free_chunks(0);
+
+                m_chunks = std::move(o.m_chunks);
+                m_size = o.m_size;
+
+                o.m_size = 0;
+            }
+
+            return *this;
+        }
+
+        // Destructor
+        ~segmented_pod_vector()
+        {
+            impl_free_chunks(0);
+        }
+
+        // Returns const value at i
+        template<class U>
+        const T& operator[](U i) const
+        {
+            assert(static_cast<size_t>(i) < m_size);
+            return m_chunks[static_cast<size_t>(i) >> ChunkShift][static_cast<size_t>(i) & (chunk_size - 1u)];
+        }
+
+        // Returns const value at i
+        template<class U>
+        const T& at(U i) const
+        {
+            return operator[](i);
+        }
+
+        // Returns value at i
+        template<class U>
+        T& operator[](U i)
+        {
+            assert(static_cast<size_t>(i) < m_size);
+            return m_chunks[static_cast<size_t>(i) >> ChunkShift][static_cast<size_t>(i) & (chunk_size - 1u)];
+        }
+
+        // Returns value at i
+        template<class U>
+        T& at(U i)
+        {
+            return operator[](i);
+        }
+
+        // Reserves memory equal to n elements
+        void reserve(size_t n)
+        {
+            impl_reserve_chunks((n + chunk_size - 1u) >> ChunkShift);
+        }
+
+        // Resizes the vector to n elements without initializing them
+        void resize(size_t n)
+        {
+            reserve(n);
+            m_size = n;
+        }
+
+        // Resizes the vector to n elements and initializing them to x
+        void resize(size_t n, T x)
+        {
+            size_t i = m_size;
+
+            resize(n);
+
+            for (; i < n; ++i)
+            {
+                operator[](i) = x;
+            }
+        }
+
+        // Sets size to 0
+        // chunks are kept for reuse
+        void clear()
+        {
+            m_size = 0;
+        }
+
+        // Frees chunks that hold no elements
+        void shrink_to_fit()
+        {
+            impl_free_chunks((m_size + chunk_size - 1u) >> ChunkShift);
+            m_chunks.shrink_to_fit();
+        }
+
+        // Returns true if the vector is empty (size = 0)
+        [[nodiscard]]
+        bool empty() const
+        {
+            return m_size == 0u;
+        }
+
+        // Returns the number of elements in the vector
+        [[nodiscard]]
+        size_t size() const
+        {
+            return m_size;
+        }
+
+        // Returns the element capacity of the vector
+        [[nodiscard]]
+        size_t capacity() const
+        {
+            return m_chunks.size() << ChunkShift;
+        }
+
+        // Returns the number of chunks holding elements
+        [[nodiscard]]
+        size_t chunk_count() const
+        {
+            return (m_size + chunk_size - 1u) >> ChunkShift;
+        }
+
+        // Returns the elements of chunk i
+        // only the last chunk may hold fewer than chunk_size elements
+        [[nodiscard]]
+        pod_span<T> chunk(size_t i)
+        {
+            assert(i < chunk_count());
+            return pod_span<T>(m_chunks[i], impl_chunk_length(i));
+        }
+
+        // Returns the elements of chunk i
+        [[nodiscard]]
+        pod_span<const T> chunk(size_t i) const
+        {
+            assert(i < chunk_count());
+            return pod_span<const T>(m_chunks[i], impl_chunk_length(i));
+        }
+
+        // Calls f(pod_span<T>) for every chunk, in order
+        template<class F>
+        void for_each_chunk(F&& f)
+        {
+            size_t n = chunk_count();
+            for (size_t i = 0; i != n; ++i)
+            {
+                f(chunk(i));
+            }
+        }
+
+        // Calls f(pod_span<const T>) for every chunk, in order
+        template<class F>
+        void for_each_chunk(F&& f) const
+        {
+            size_t n = chunk_count();
+            for (size_t i = 0; i != n; ++i)
+            {
+                f(chunk(i));
+            }
+        }
+
+        // Returns iterator to the beginning of the data
+        iterator begin()
+        {
+            return iterator(m_chunks.data(), 0);
+        }
+
+        // Returns iterator to the end of the data
+        iterator end()
+        {
+            return iterator(m_chunks.data(), m_size);
+        }
+
+        // Returns const iterator to the beginning of the data
+        const_iterator cbegin() const
+        {
+            return const_iterator(m_chunks.data(), 0);
+        }
+
+        // Returns const iterator to the end of the data
+        const_iterator cend() const
+        {
+            return const_iterator(m_chunks.data(), m_size);
+        }
+
+        // Pushes an element to the end of the data
+        void push_back(const T& o)
+        {
+            // last chunk is full
+            if (m_size == capacity())
+            {
+                impl_reserve_chunks(m_chunks.size() + 1u);
+            }
+
+            operator[](m_size++) = o;
+        }
+
+        // Pushes an array of n elements to the end of the data
+        void push_back(const T* o, size_t n)
+        {
+            reserve(m_size + n);
+
+            // copy chunk by chunk
+            while (n > 0)
+            {
+                size_t offset = m_size & (chunk_size - 1u);
+                size_t count = chunk_size - offset;
+
+                if (count > n)
+                {
+                    count = n;
+                }
+
+                memcpy(m_chunks[m_size >> ChunkShift] + offset, o, count * sizeof(T));
+
+                o += count;
+                n -= count;
+                m_size += count;
+            }
+        }
+
+        // Pops an element from the end of the data
+        void pop_back()
+        {
+            assert(m_size > 0u);
+            --m_size;
+        }
+
+        // Returns reference to the first element
+        T& front()
+        {
+            assert(m_size > 0u);
+            return m_chunks[0][0];
+        }
+
+        // Returns const reference to the first element
+        const T& front() const
+        {
+            assert(m_size > 0u);
+            return m_chunks[0][0];
+        }
+
+        // Returns reference to the last element
+        T& back()
+        {
+            assert(m_size > 0u);
+            return operator[](m_size - 1u);
+        }
+
+        // Returns const reference to the last element
+        const T& back() const
+        {
+            assert(m_size > 0u);
+            return operator[](m_size - 1u);
+        }
+
+    protected:
+        pod_vector<T*> m_chunks;
+        size_t m_size;
+
+        // Number of elements in chunk i
+        size_t impl_chunk_length(size_t i) const
+        {
+            size_t begin = i << ChunkShift;
+            return (m_size - begin < chunk_size)
+                ? (m_size - begin)
+                : chunk_size;
+        }
+
+        // Allocates chunks until there are n
+        // only the chunk table is reallocated, elements never move
+        void impl_reserve_chunks(size_t n)
+        {
+            while (m_chunks.size() < n)
+            {
+                m_chunks.push_back(new T[chunk_size]);
+            }
+        }
+
+        // Frees chunks until there are n
+        void impl_free_chunks(size_t n)
+        {
+            while (m_chunks.size() > n)
+            {
+                delete[] m_chunks.back();
+                m_chunks.pop_back();
+            }
+        }
+
+        void impl_copy(const segmented_pod_vector& o)
+        {
+            reserve(o.m_size);
+
+            size_t n = o.chunk_count();
+            for (size_t i = 0; i != n; ++i)
+            {
+                memcpy(m_chunks[i], o.m_chunks[i], o.impl_chunk_length(i) * sizeof(T));
+            }
+
+            m_size = o.m_size;
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,248 @@
+// k13
+// Kyle J Burgess
+
+#ifndef K13_SHARED_POD_VECTOR_H
+#define K13_SHARED_POD_VECTOR_H
+
+#include "pod_vector.h"
+#include "pod_span.h"
+
+#include <atomic>
+#include <cstring>
+#include <cassert>
+#include <memory>
+
+namespace k13
+{
+    // A reference counted, copy-on-write buffer of POD types
+    // Copies and slices share one buffer, and are safe to hand off between threads
+    // The buffer is only copied when a view that shares it is written to
+
+    template<class T>
+    class shared_pod_vector
+    {
+    public:
+
+        using const_iterator = basic_iterator<const T>;
+        using const_reverse_iterator = basic_reverse_iterator<const T>;
+
+        // Constructor
+        shared_pod_vector() : m_buffer(), m_capacity(0), m_data(nullptr), m_size(0)
+        {}
+
+        // Freeze a pod_vector in O(1), taking ownership of its buffer
+        explicit shared_pod_vector(pod_vector<T>&& v) : m_buffer(), m_capacity(v.m_capacity), m_data(v.m_data), m_size(v.m_size)
+        {
+            if (m_data != nullptr)
+            {
+                m_buffer = std::shared_ptr<T>(m_data, impl_deleter());
+            }
+
+            v.m_data = nullptr;
+            v.m_size = 0;
+            v.m_capacity = 0;
+        }
+
+        // Returns const value at i
+        template<class U>
+        const T& operator[](U i) const
+        {
+            assert(static_cast<size_t>(i) < m_size);
+            return m_data[i];
+        }
+
+        // Returns const value at i
+        template<class U>
+        const T& at(U i) const
+        {
+            assert(static_cast<size_t>(i) < m_size);
+            return m_data[i];
+        }
+
+        // Returns a view of n elements starting at element i
+        // the view shares (and keeps alive) this buffer
+        [[nodiscard]]
+        shared_pod_vector slice(size_t i, size_t n) const
+        {
+            assert(i + n <= m_size);
+
+            shared_pod_vector r(*this);
+            r.m_data += i;
+            r.m_size = n;
+            return r;
+        }
+
+        // Returns a non-owning view of the elements
+        // the view is valid as long as this shared_pod_vector is
+        [[nodiscard]]
+        pod_span<const T> span() const
+        {
+            return pod_span<const T>(m_data, m_size);
+        }
+
+        // Returns true if no other shared_pod_vector shares this buffer
+        // use_count() is a relaxed load, so seeing 1 is followed by an acquire fence,
+        // which orders this view's writes after the reads of views released on other threads
+        [[nodiscard]]
+        bool unique() const
+        {
+            if (m_buffer.use_count() <= 1)
+            {
+                std::atomic_thread_fence(std::memory_order_acquire);
+                return true;
+            }
+
+            return false;
+        }
+
+        // Returns a writable pointer to the elements
+        // copies the elements into a new buffer if the buffer is shared
+        T* mutable_data()
+        {
+            if (!unique())
+            {
+                impl_detach();
+            }
+
+            return m_data;
+        }
+
+        // Returns writable value at i
+        // copies the elements into a new buffer if the buffer is shared
+        template<class U>
+        T& mutable_at(U i)
+        {
+            assert(static_cast<size_t>(i) < m_size);
+            return mutable_data()[i];
+        }
+
+        // Convert back into a pod_vector
+        // the buffer is moved if this is the only view of it, otherwise it is copied
+        [[nodiscard]]
+        pod_vector<T> thaw() &&
+        {
+            pod_vector<T> r;
+
+            if (unique() && m_data == m_buffer.get())
+            {
+                // Take over the allocation, and stop the control block from deleting it
+                std::get_deleter<impl_deleter>(m_buffer)->released = true;
+
+                r.m_data = m_data;
+                r.m_size = m_size;
+                r.m_capacity = m_capacity;
+            }
+            else if (m_size > 0)
+            {
+                r.resize(m_size);
+                memcpy(r.m_data, m_data, m_size * sizeof(T));
+            }
+
+            m_buffer.reset();
+            m_capacity = 0;
+            m_data = nullptr;
+            m_size = 0;
+
+            return r;
+        }
+
+        // Returns true if the vector is empty (size = 0)
+        [[nodiscard]]
+        bool empty() const
+        {
+            return m_size == 0u;
+        }
+
+        // Returns the number of elements in the vector
+        [[nodiscard]]
+        size_t size() const
+        {
+            return m_size;
+        }
+
+        // Returns const pointer to data
+        const T* data() const
+        {
+            return m_data;
+        }
+
+        // Returns const iterator to the beginning of the data
+        const_iterator cbegin() const
+        {
+            return const_iterator(m_data);
+        }
+
+        // Returns const iterator to the end of the data
+        const_iterator cend() const
+        {
+            return const_iterator(m_data + m_size);
+        }
+
+        // Returns iterator to the reverse beginning of the data
+        const_reverse_iterator crbegin() const
+        {
+            return const_reverse_iterator(m_data + m_size - 1);
+        }
+
+        // Returns iterator to the reverse end of the data
+        const_reverse_iterator crend() const
+        {
+            return const_reverse_iterator(m_data - 1);
+        }
+
+        // Returns const reference to the first element
+        const T& front() const
+        {
+            assert(m_size > 0u);
+            return m_data[0];
+        }
+
+        // Returns const reference to the last element
+        const T& back() const
+        {
+            assert(m_size > 0u);
+            return m_data[m_size - 1u];
+        }
+
+    protected:
+        std::shared_ptr<T> m_buffer;
+        size_t m_capacity;
+        T* m_data;
+        size_t m_size;
+
+        // Deletes the buffer, unless thaw() has taken it over
+        struct impl_deleter
+        {
+            bool released = false;
+
+            void operator()(T* ptr) const
+            {
+                if (!released)
+                {
+                    delete[] ptr;
+                }
+            }
+        };
+
+        // Copy the viewed elements into a buffer owned only by this view
+        void impl_detach()
+        {
+            if (m_size == 0)
+            {
+                m_buffer.reset();
+                m_capacity = 0;
+                m_data = nullptr;
+                return;
+            }
+
+            T* data = new T[m_size];
+            memcpy(data, m_data, m_size * sizeof(T));
+
+            m_buffer = std::shared_ptr<T>(data, impl_deleter());
+            m_capacity = m_size;
+            m_data = data;
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,447 @@
+// k13
+// Kyle J Burgess
+
+#ifndef K13_SOA_VECTOR_H
+#define K13_SOA_VECTOR_H
+
+#include "pod_vector.h"
+
+#include <cstddef>
+#include <cassert>
+#include <iterator>
+#include <utility>
+#include <tuple>
+
+namespace k13
+{
+    // Random access iterator over the rows of a soa_vector
+    // Dereferencing returns a tuple of references (one per column)
+
+    template<class... Fields>
+    class soa_iterator
+    {
+    public:
+
+        // Type Traits
+        using difference_type = std::ptrdiff_t;
+        using value_type = std::tuple<std::remove_const_t<Fields>...>;
+        using pointer = void;
+        using reference = std::tuple<Fields&...>;
+        using iterator_category = std::random_access_iterator_tag;
+
+        // Constructor
+        explicit soa_iterator(std::tuple<Fields*...> ptrs = {}, size_t i = 0)
+            : m_ptrs(ptrs)
+            , m_i(i)
+        {}
+
+        // Pre-increment Operator
+        soa_iterator& operator++()
+        {
+            ++m_i;
+            return *this;
+        }
+
+        // Post-increment Operator
+        soa_iterator operator++(int)
+        {
+            const auto r = *this;
+            ++m_i;
+            return r;
+        }
+
+        // Pre-decrement Operator
+        soa_iterator& operator--()
+        {
+            --m_i;
+            return *this;
+        }
+
+        // Post-decrement Operator
+        soa_iterator operator--(int)
+        {
+            const auto r = *this;
+            --m_i;
+            return r;
+        }
+
+        // Addition Operator
+        [[nodiscard]]
+        soa_iterator operator+(difference_type d) const
+        {
+            return soa_iterator(m_ptrs, m_i + d);
+        }
+
+        // Subtraction Operator
+        [[nodiscard]]
+        soa_iterator operator-(difference_type d) const
+        {
+            return soa_iterator(m_ptrs, m_i - d);
+        }
+
+        // Subtraction Operator
+        [[nodiscard]]
+        difference_type operator-(const soa_iterator& o) const
+        {
+            return static_cast<difference_type>(m_i) - static_cast<difference_type>(o.m_i);
+        }
+
+        // Increment Operator
+        soa_iterator& operator+=(difference_type d)
+        {
+            m_i += d;
+            return *this;
+        }
+
+        // Decrement Operator
+        soa_iterator& operator-=(difference_type d)
+        {
+            m_i -= d;
+            return *this;
+        }
+
+        // Equality Operator
+        [[nodiscard]]
+        bool operator==(const soa_iterator& o) const
+        {
+            return m_i == o.m_i;
+        }
+
+        // Inequality Operator
+        [[nodiscard]]
+        bool operator!=(const soa_iterator& o) const
+        {
+            return m_i != o.m_i;
+        }
+
+        // Less Than Operator
+        [[nodiscard]]
+        bool operator<(const soa_iterator& o) const
+        {
+            return m_i < o.m_i;
+        }
+
+        // Less Than or Equal Operator
+        [[nodiscard]]
+        bool operator<=(const soa_iterator& o) const
+        {
+            return m_i <= o.m_i;
+        }
+
+        // Greater Than Operator
+        [[nodiscard]]
+        bool operator>(const soa_iterator& o) const
+        {
+            return m_i > o.m_i;
+        }
+
+        // Greater Than or Equal Operator
+        [[nodiscard]]
+        bool operator>=(const soa_iterator& o) const
+        {
+            return m_i >= o.m_i;
+        }
+
+        // Addition Operator
+        [[nodiscard]]
+        friend soa_iterator operator+(difference_type d, const soa_iterator& it)
+        {
+            return it + d;
+        }
+
+        // Pointer Operator
+        [[nodiscard]]
+        reference operator*() const
+        {
+            return impl_deref(std::index_sequence_for<Fields...>());
+        }
+
+        // Subscript Operator
+        [[nodiscard]]
+        reference operator[](difference_type d) const
+        {
+            return *(*this + d);
+        }
+
+        // Returns the field I of the current row
+        template<size_t I>
+        [[nodiscard]]
+        auto& get() const
+        {
+            return std::get<I>(m_ptrs)[m_i];
+        }
+
+    protected:
+        std::tuple<Fields*...> m_ptrs;
+        size_t m_i;
+
+        template<size_t... Is>
+        reference impl_deref(std::index_sequence<Is...>) const
+        {
+            return reference(std::get<Is>(m_ptrs)[m_i]...);
+        }
+    };
+
+    // A structure-of-arrays vector
+    // Each field is stored in its own pod_vector column, so a scan over
+    // one field only loads that field's memory
+    // Columns start on a 64 byte boundary, so scans of them begin with aligned simd loads
+
+    template<class... Fields>
+    class soa_vector
+    {
+    public:
+
+        static_assert(sizeof...(Fields) > 0, "soa_vector requires at least one field");
+
+        using value_type = std::tuple<Fields...>;
+        using reference = std::tuple<Fields&...>;
+        using const_reference = std::tuple<const Fields&...>;
+        using iterator = soa_iterator<Fields...>;
+        using const_iterator = soa_iterator<const Fields...>;
+
+        // Type of field I
+        template<size_t I>
+        using field_type = std::tuple_element_t<I, value_type>;
+
+        // Alignment of the columns, or of a field that needs more
+        static constexpr size_t column_alignment = 64;
+
+        // Column of a field of type F
+        template<class F>
+        using column_type = pod_vector<F, (alignof(F) > column_alignment) ? alignof(F) : column_alignment>;
+
+        // Number of fields (columns)
+        static constexpr size_t field_count = sizeof...(Fields);
+
+        // Constructor
+        soa_vector() = default;
+
+        // Constructor
+        explicit soa_vector(size_t size)
+            : m_columns(column_type<Fields>(size)...)
+        {}
+
+        // Returns row i as a tuple of references
+        template<class U>
+        reference operator[](U i)
+        {
+            assert(static_cast<size_t>(i) < size());
+            return impl_row(static_cast<size_t>(i), std::index_sequence_for<Fields...>());
+        }
+
+        // Returns row i as a tuple of const references
+        template<class U>
+        const_reference operator[](U i) const
+        {
+            assert(static_cast<size_t>(i) < size());
+            return impl_row(static_cast<size_t>(i), std::index_sequence_for<Fields...>());
+        }
+
+        // Returns field I of row i
+        template<size_t I, class U>
+        field_type<I>& get(U i)
+        {
+            return std::get<I>(m_columns)[i];
+        }
+
+        // Returns field I of row i
+        template<size_t I, class U>
+        const field_type<I>& get(U i) const
+        {
+            return std::get<I>(m_columns)[i];
+        }
+
+        // Returns the column of field I
+        // columns must not be resized directly
+        template<size_t I>
+        column_type<field_type<I>>& column()
+        {
+            return std::get<I>(m_columns);
+        }
+
+        // Returns the column of field I
+        template<size_t I>
+        const column_type<field_type<I>>& column() const
+        {
+            return std::get<I>(m_columns);
+        }
+
+        // Reserves memory equal to n rows in every column
+        void reserve(size_t n)
+        {
+            std::apply([n](auto&... c) { (c.reserve(n), ...); }, m_columns);
+        }
+
+        // Resizes every column to n rows without initializing them
+        void resize(size_t n)
+        {
+            std::apply([n](auto&... c) { (c.resize(n), ...); }, m_columns);
+        }
+
+        // Resizes every column to n rows, initializing new rows to x...
+        void resize(size_t n, const Fields&... x)
+        {
+            impl_resize(n, std::forward_as_tuple(x...), std::index_sequence_for<Fields...>());
+        }
+
+        // Sets size to 0
+        void clear()
+        {
+            std::apply([](auto&... c) { (c.clear(), ...); }, m_columns);
+        }
+
+        // Shrink capacity of every column to fit size
+        void shrink_to_fit()
+        {
+            std::apply([](auto&... c) { (c.shrink_to_fit(), ...); }, m_columns);
+        }
+
+        // Returns true if the vector is empty (size = 0)
+        [[nodiscard]]
+        bool empty() const
+        {
+            return size() == 0u;
+        }
+
+        // Returns the number of rows in the vector
+        [[nodiscard]]
+        size_t size() const
+        {
+            return std::get<0>(m_columns).size();
+        }
+
+        // Pushes a row to the end of every column
+        void push_back(const Fields&... x)
+        {
+            impl_push_back(std::forward_as_tuple(x...), std::index_sequence_for<Fields...>());
+        }
+
+        // Pushes a row to the end of every column
+        void push_back(const value_type& x)
+        {
+            impl_push_back(x, std::index_sequence_for<Fields...>());
+        }
+
+        // Pops a row from the end of every column
+        void pop_back()
+        {
+            assert(size() > 0u);
+            std::apply([](auto&... c) { (c.pop_back(), ...); }, m_columns);
+        }
+
+        // Pushes n records of an array-of-structures to the end of the vector
+        // members selects the field of Record stored in each column
+        template<class Record>
+        void push_back_aos(const Record* records, size_t n, Fields Record::*... members)
+        {
+            size_t offset = size();
+            resize(offset + n);
+            impl_scatter(records, n, offset, std::make_tuple(members...), std::index_sequence_for<Fields...>());
+        }
+
+        // Copies every row into an array-of-structures of size() records
+        // members selects the field of Record written from each column
+        template<class Record>
+        void copy_to_aos(Record* records, Fields Record::*... members) const
+        {
+            impl_gather(records, std::make_tuple(members...), std::index_sequence_for<Fields...>());
+        }
+
+        // Returns iterator to the beginning of the rows
+        iterator begin()
+        {
+            return iterator(impl_pointers(std::index_sequence_for<Fields...>()), 0);
+        }
+
+        // Returns iterator to the end of the rows
+        iterator end()
+        {
+            return iterator(impl_pointers(std::index_sequence_for<Fields...>()), size());
+        }
+
+        // Returns const iterator to the beginning of the rows
+        const_iterator cbegin() const
+        {
+            return const_iterator(impl_pointers(std::index_sequence_for<Fields...>()), 0);
+        }
+
+        // Returns const iterator to the end of the rows
+        const_iterator cend() const
+        {
+            return const_iterator(impl_pointers(std::index_sequence_for<Fields...>()), size());
+        }
+
+    protected:
+        std::tuple<column_type<Fields>...> m_columns;
+
+        template<size_t... Is>
+        reference impl_row(size_t i, std::index_sequence<Is...>)
+        {
+            return reference(std::get<Is>(m_columns)[i]...);
+        }
+
+        template<size_t... Is>
+        const_reference impl_row(size_t i, std::index_sequence<Is...>) const
+        {
+            return const_reference(std::get<Is>(m_columns)[i]...);
+        }
+
+        template<size_t... Is>
+        std::tuple<Fields*...> impl_pointers(std::index_sequence<Is...>)
+        {
+            return std::tuple<Fields*...>(std::get<Is>(m_columns).data()...);
+        }
+
+        template<size_t... Is>
+        std::tuple<const Fields*...> impl_pointers(std::index_sequence<Is...>) const
+        {
+            return std::tuple<const Fields*...>(std::get<Is>(m_columns).data()...);
+        }
+
+        template<class Tuple, size_t... Is>
+        void impl_resize(size_t n, const Tuple& x, std::index_sequence<Is...>)
+        {
+            (std::get<Is>(m_columns).resize(n, std::get<Is>(x)), ...);
+        }
+
+        template<class Tuple, size_t... Is>
+        void impl_push_back(const Tuple& x, std::index_sequence<Is...>)
+        {
+            (std::get<Is>(m_columns).push_back(std::get<Is>(x)), ...);
+        }
+
+        template<class Record, class Members, size_t... Is>
+        void impl_scatter(const Record* records, size_t n, size_t offset, const Members& members, std::index_sequence<Is...>)
+        {
+            // One pass per column keeps each write stream sequential
+            (impl_scatter_column(records, n, std::get<Is>(m_columns).data() + offset, std::get<Is>(members)), ...);
+        }
+
+        template<class Record, class Field>
+        static void impl_scatter_column(const Record* records, size_t n, Field* dst, Field Record::* member)
+        {
+            for (size_t i = 0; i != n; ++i)
+            {
+                dst[i] = records[i].*member;
+            }
+        }
+
+        template<class Record, class Members, size_t... Is>
+        void impl_gather(Record* records, const Members& members, std::index_sequence<Is...>) const
+        {
+            (impl_gather_column(records, size(), std::get<Is>(m_columns).data(), std::get<Is>(members)), ...);
+        }
+
+        template<class Record, class Field>
+        static void impl_gather_column(Record* records, size_t n, const Field* src, Field Record::* member)
+        {
+            for (size_t i = 0; i != n; ++i)
+            {
+                records[i].*member = src[i];
+            }
+        }
+    };
+}
+
+#endif
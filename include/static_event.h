@@ -0,0 +1,149 @@
+// k13
+// Kyle J Burgess
+
+#ifndef K13_STATIC_EVENT_H
+#define K13_STATIC_EVENT_H
+
+#include "event.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace k13
+{
+    // Handler type that calls a function known at compile time
+    template<auto Function>
+    struct static_handler
+    {
+        template<class... Args>
+        decltype(auto) operator()(Args&&... args) const
+        {
+            return Function(std::forward<Args>(args)...);
+        }
+    };
+
+    // Static Event
+    // An event whose subscribers are handler types fixed at compile time, so invoke
+    // is a fold over direct calls that the compiler can inline completely
+    // Handlers returning callback_persistence may remove themselves, which clears
+    // their bit in an active mask; handlers returning anything else are always called
+    template<class... Handlers>
+    class static_event
+    {
+    public:
+
+        static_assert(sizeof...(Handlers) <= 64, "static_event supports up to 64 handlers");
+
+        // Number of handlers
+        static constexpr size_t handler_count = sizeof...(Handlers);
+
+        // Constructor
+        static_event()
+            : m_active(impl_all_active())
+        {}
+
+        // Constructor
+        explicit static_event(Handlers... handlers)
+            : m_handlers(std::move(handlers)...)
+            , m_active(impl_all_active())
+        {}
+
+        // Invokes the event with args
+        // calling every active handler in order, which all receive the same arguments
+        template<class... Args>
+        void invoke(Args&&... args)
+        {
+            impl_invoke(std::index_sequence_for<Handlers...>(), args...);
+        }
+
+        // Returns handler I
+        template<size_t I>
+        [[nodiscard]]
+        auto& handler()
+        {
+            return std::get<I>(m_handlers);
+        }
+
+        // Returns handler I (const)
+        template<size_t I>
+        [[nodiscard]]
+        const auto& handler() const
+        {
+            return std::get<I>(m_handlers);
+        }
+
+        // True if handler I has not removed itself
+        template<size_t I>
+        [[nodiscard]]
+        bool active() const
+        {
+            return (m_active & (uint64_t(1) << I)) != 0;
+        }
+
+        // Sets whether handler I is called
+        // handlers that do not return callback_persistence are always called
+        template<size_t I>
+        void set_active(bool active)
+        {
+            if (active)
+            {
+                m_active |= uint64_t(1) << I;
+            }
+            else
+            {
+                m_active &= ~(uint64_t(1) << I);
+            }
+        }
+
+        // Reactivates every handler
+        void reset()
+        {
+            m_active = impl_all_active();
+        }
+
+    protected:
+
+        std::tuple<Handlers...> m_handlers;
+        uint64_t m_active;
+
+        static constexpr uint64_t impl_all_active()
+        {
+            return (handler_count == 64)
+                ? ~uint64_t(0)
+                : (uint64_t(1) << handler_count) - 1u;
+        }
+
+        template<size_t... I, class... Args>
+        void impl_invoke(std::index_sequence<I...>, Args&... args)
+        {
+            (impl_call<I>(args...), ...);
+        }
+
+        template<size_t I, class... Args>
+        void impl_call(Args&... args)
+        {
+            auto& h = std::get<I>(m_handlers);
+
+            using result_type = decltype(h(args...));
+
+            if constexpr (std::is_same<typename std::decay<result_type>::type, callback_persistence>::value)
+            {
+                constexpr uint64_t bit = uint64_t(1) << I;
+
+                if ((m_active & bit) != 0 && h(args...) == remove_callback)
+                {
+                    m_active &= ~bit;
+                }
+            }
+            else
+            {
+                h(args...);
+            }
+        }
+    };
+}
+
+#endif
@@ -94,6 +94,10 @@ namespace k13
         // Run a new task
         void run(thread_task& task, std::function<void()> func);
 
+        // Returns the number of threads in the thread pool
+        [[nodiscard]]
+        size_t size() const;
+
     protected:
 
         std::mutex m_queue_mtx;
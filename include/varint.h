@@ -0,0 +1,465 @@
+// k13
+// Kyle J Burgess
+
+#ifndef K13_VARINT_H
+#define K13_VARINT_H
+
+#include "binary_io.h"
+#include "pod_vector.h"
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+// Check for sse2 bit packing kernels, which every x86-64 cpu supports
+#undef K13_SSE2_SUPPORT
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define K13_SSE2_SUPPORT
+#include <emmintrin.h>
+#endif
+
+namespace k13
+{
+    // Maps signed integers to unsigned so that small magnitudes stay small,
+    // 0, -1, 1, -2, 2 ... to 0, 1, 2, 3, 4 ...
+    constexpr uint32_t zigzag_encode(int32_t x)
+    {
+        return (static_cast<uint32_t>(x) << 1u) ^ static_cast<uint32_t>(x >> 31);
+    }
+
+    constexpr uint64_t zigzag_encode(int64_t x)
+    {
+        return (static_cast<uint64_t>(x) << 1u) ^ static_cast<uint64_t>(x >> 63);
+    }
+
+    // Inverse of zigzag_encode
+    constexpr int32_t zigzag_decode(uint32_t x)
+    {
+        return static_cast<int32_t>((x >> 1u) ^ (0u - (x & 1u)));
+    }
+
+    constexpr int64_t zigzag_decode(uint64_t x)
+    {
+        return static_cast<int64_t>((x >> 1u) ^ (0u - (x & 1u)));
+    }
+
+    // Largest LEB128 encoding of a 64-bit value
+    constexpr size_t varint_max_size = 10;
+
+    // Returns the number of bytes in the LEB128 encoding of x
+    constexpr size_t varint_size(uint64_t x)
+    {
+        size_t n = 1;
+
+        for (; x >= 0x80u; x >>= 7u)
+        {
+            ++n;
+        }
+
+        return n;
+    }
+
+    // Writes x as LEB128 to dst, which must have room for varint_size(x) bytes
+    // returns the number of bytes written
+    K13_INLINE_ATTRIBUTE
+    size_t varint_encode(uint64_t x, uint8_t* dst)
+    {
+        size_t n = 0;
+
+        for (; x >= 0x80u; x >>= 7u)
+        {
+            dst[n++] = static_cast<uint8_t>(x | 0x80u);
+        }
+
+        dst[n++] = static_cast<uint8_t>(x);
+
+        return n;
+    }
+
+    // Reads a LEB128 value from the size bytes at src
+    // returns the number of bytes read, or 0 if the value is truncated, longer than 64 bits,
+    // or not in its shortest encoding (a last byte of 0 after the first, such as 80 00)
+    K13_INLINE_ATTRIBUTE
+    size_t varint_decode(const uint8_t* src, size_t size, uint64_t& x)
+    {
+        // Most values are one byte
+        if (size != 0 && src[0] < 0x80u)
+        {
+            x = src[0];
+            return 1;
+        }
+
+        size_t limit = (size < varint_max_size) ? size : varint_max_size;
+        uint64_t value = 0;
+
+        for (size_t i = 0; i != limit; ++i)
+        {
+            uint64_t b = src[i];
+            value |= (b & 0x7fu) << (7u * i);
+
+            if (b < 0x80u)
+            {
+                // the tenth byte may only hold the top bit, and only the first byte may be 0
+                if ((i == varint_max_size - 1u && b > 1u) || b == 0)
+                {
+                    return 0;
+                }
+
+                x = value;
+                return i + 1u;
+            }
+        }
+
+        return 0;
+    }
+
+    // Appends x as LEB128 to v
+    inline void varint_append(pod_vector<uint8_t>& v, uint64_t x)
+    {
+        size_t size = v.size();
+        v.resize(size + varint_max_size);
+        v.resize(size + varint_encode(x, v.data() + size));
+    }
+
+    // Appends n unsigned integers as LEB128 to v
+    template<class T>
+    void varint_append(pod_vector<uint8_t>& v, const T* x, size_t n)
+    {
+        static_assert(std::is_unsigned<T>::value && sizeof(T) <= 8, "varint_append requires unsigned integers of at most 64 bits");
+
+        size_t size = v.size();
+        v.resize(size + n * varint_max_size);
+
+        uint8_t* dst = v.data() + size;
+        for (size_t i = 0; i != n; ++i)
+        {
+            dst += varint_encode(x[i], dst);
+        }
+
+        v.resize(static_cast<size_t>(dst - v.data()));
+    }
+
+    // Reads n LEB128 values from the size bytes at src
+    // returns the number of bytes read, or 0 if src is truncated, or a value is not in its
+    // shortest encoding or does not fit in T
+    template<class T>
+    size_t varint_decode(const uint8_t* src, size_t size, T* dst, size_t n)
+    {
+        static_assert(std::is_unsigned<T>::value && sizeof(T) <= 8, "varint_decode requires unsigned integers of at most 64 bits");
+
+        size_t position = 0;
+
+        for (size_t i = 0; i != n; ++i)
+        {
+            uint64_t x;
+            size_t read = varint_decode(src + position, size - position, x);
+
+            if (read == 0 || x > std::numeric_limits<T>::max())
+            {
+                return 0;
+            }
+
+            dst[i] = static_cast<T>(x);
+            position += read;
+        }
+
+        return position;
+    }
+
+    // Bit Packing
+    // Blocks of 128 uint32_t values are packed to a fixed number of bits each, in 16 * bits bytes,
+    // using the SIMD-BP128 layout: value i belongs to lane i % 4, and each lane packs its
+    // 32 values into the little endian 32-bit words 4 * k + lane
+    // The lanes make every step one 128-bit shift and or, so the sse2 kernels and the
+    // scalar kernels read and write the same bytes
+
+    // Values in one bit packed block
+    constexpr size_t bitpack_block_size = 128;
+
+    // Returns the bytes in one block packed to bits
+    constexpr size_t bitpack_bytes(uint32_t bits)
+    {
+        return 16u * bits;
+    }
+
+    // Returns the number of bits needed by the largest of n values
+    inline uint32_t bitpack_width(const uint32_t* x, size_t n)
+    {
+        uint32_t any = 0;
+
+        for (size_t i = 0; i != n; ++i)
+        {
+            any |= x[i];
+        }
+
+        uint32_t bits = 0;
+
+        for (; any != 0; any >>= 1u)
+        {
+            ++bits;
+        }
+
+        return bits;
+    }
+
+    template<uint32_t Bits>
+    constexpr uint32_t impl_bitpack_mask()
+    {
+        return (Bits == 32) ? ~uint32_t(0) : ((uint32_t(1) << Bits) - 1u);
+    }
+
+    // Pack 128 values to Bits each
+    template<uint32_t Bits>
+    void impl_bitpack128_scalar(const uint32_t* src, uint8_t* dst)
+    {
+        for (size_t lane = 0; lane != 4; ++lane)
+        {
+            uint32_t word = 0;
+            uint32_t shift = 0;
+            size_t k = 0;
+
+            for (size_t i = 0; i != 32; ++i)
+            {
+                uint32_t v = src[4u * i + lane] & impl_bitpack_mask<Bits>();
+
+                word |= v << shift;
+                shift += Bits;
+
+                if (shift >= 32)
+                {
+                    word = to_endian<little_endian>(word);
+                    memcpy(dst + 4u * (4u * k + lane), &word, 4);
+                    ++k;
+
+                    shift -= 32;
+                    word = (shift != 0) ? (v >> (Bits - shift)) : 0;
+                }
+            }
+        }
+    }
+
+    // Unpack 128 values of Bits each
+    template<uint32_t Bits>
+    void impl_bitunpack128_scalar(const uint8_t* src, uint32_t* dst)
+    {
+        for (size_t lane = 0; lane != 4; ++lane)
+        {
+            uint32_t word;
+            uint32_t shift = 0;
+            size_t k = 0;
+
+            memcpy(&word, src + 4u * lane, 4);
+            word = to_endian<little_endian>(word);
+
+            for (size_t i = 0; i != 32; ++i)
+            {
+                uint32_t v = word >> shift;
+                shift += Bits;
+
+                if (shift >= 32)
+                {
+                    shift -= 32;
+                    ++k;
+
+                    // the last value of a lane ends exactly on its last word
+                    if (i != 31)
+                    {
+                        memcpy(&word, src + 4u * (4u * k + lane), 4);
+                        word = to_endian<little_endian>(word);
+
+                        if (shift != 0)
+                        {
+                            v |= word << (Bits - shift);
+                        }
+                    }
+                }
+
+                dst[4u * i + lane] = v & impl_bitpack_mask<Bits>();
+            }
+        }
+    }
+
+#ifdef K13_SSE2_SUPPORT
+    // Pack 128 values to Bits each, four lanes at a time
+    template<uint32_t Bits>
+    void impl_bitpack128_sse2(const uint32_t* src, uint8_t* dst)
+    {
+        const __m128i mask = _mm_set1_epi32(static_cast<int>(impl_bitpack_mask<Bits>()));
+
+        __m128i word = _mm_setzero_si128();
+        uint32_t shift = 0;
+
+        for (size_t i = 0; i != 32; ++i)
+        {
+            __m128i v = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 4u * i)), mask);
+
+            word = _mm_or_si128(word, _mm_slli_epi32(v, static_cast<int>(shift)));
+            shift += Bits;
+
+            if (shift >= 32)
+            {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), word);
+                dst += 16;
+
+                shift -= 32;
+                word = (shift != 0) ? _mm_srli_epi32(v, static_cast<int>(Bits - shift)) : _mm_setzero_si128();
+            }
+        }
+    }
+
+    // Unpack 128 values of Bits each, four lanes at a time
+    template<uint32_t Bits>
+    void impl_bitunpack128_sse2(const uint8_t* src, uint32_t* dst)
+    {
+        const __m128i mask = _mm_set1_epi32(static_cast<int>(impl_bitpack_mask<Bits>()));
+
+        __m128i word = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        uint32_t shift = 0;
+
+        for (size_t i = 0; i != 32; ++i)
+        {
+            __m128i v = _mm_srli_epi32(word, static_cast<int>(shift));
+            shift += Bits;
+
+            if (shift >= 32)
+            {
+                shift -= 32;
+
+                if (i != 31)
+                {
+                    src += 16;
+                    word = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+
+                    if (shift != 0)
+                    {
+                        v = _mm_or_si128(v, _mm_slli_epi32(word, static_cast<int>(Bits - shift)));
+                    }
+                }
+            }
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 4u * i), _mm_and_si128(v, mask));
+        }
+    }
+#endif
+
+    template<uint32_t Bits>
+    void impl_bitpack128(const uint32_t* src, uint8_t* dst)
+    {
+        if constexpr (Bits != 0)
+        {
+        #ifdef K13_SSE2_SUPPORT
+            impl_bitpack128_sse2<Bits>(src, dst);
+        #else
+            impl_bitpack128_scalar<Bits>(src, dst);
+        #endif
+        }
+    }
+
+    template<uint32_t Bits>
+    void impl_bitunpack128(const uint8_t* src, uint32_t* dst)
+    {
+        if constexpr (Bits == 0)
+        {
+            memset(dst, 0, bitpack_block_size * sizeof(uint32_t));
+        }
+        else
+        {
+        #ifdef K13_SSE2_SUPPORT
+            impl_bitunpack128_sse2<Bits>(src, dst);
+        #else
+            impl_bitunpack128_scalar<Bits>(src, dst);
+        #endif
+        }
+    }
+
+    // Kernels for every bit width, so each has constant shifts
+    template<class Sequence>
+    struct impl_bitpack_table;
+
+    template<uint32_t... Bits>
+    struct impl_bitpack_table<std::integer_sequence<uint32_t, Bits...>>
+    {
+        static constexpr void (*pack[])(const uint32_t*, uint8_t*) = { &impl_bitpack128<Bits>... };
+        static constexpr void (*unpack[])(const uint8_t*, uint32_t*) = { &impl_bitunpack128<Bits>... };
+    };
+
+    using impl_bitpack_kernels = impl_bitpack_table<std::make_integer_sequence<uint32_t, 33>>;
+
+    // Pack 128 values to bits each, writing bitpack_bytes(bits) bytes
+    // bits of each value above bits are dropped
+    inline void bitpack128(const uint32_t* src, uint8_t* dst, uint32_t bits)
+    {
+        assert(bits <= 32);
+        impl_bitpack_kernels::pack[bits](src, dst);
+    }
+
+    // Unpack 128 values of bits each, reading bitpack_bytes(bits) bytes
+    inline void bitunpack128(const uint8_t* src, uint32_t* dst, uint32_t bits)
+    {
+        assert(bits <= 32);
+        impl_bitpack_kernels::unpack[bits](src, dst);
+    }
+
+    // Appends n values to v, as blocks of 128 packed to the width of their largest value,
+    // each preceded by its width in one byte, and the last n % 128 values as LEB128
+    inline void bitpack_append(pod_vector<uint8_t>& v, const uint32_t* x, size_t n)
+    {
+        size_t blocks = n / bitpack_block_size;
+
+        for (size_t i = 0; i != blocks; ++i)
+        {
+            const uint32_t* block = x + i * bitpack_block_size;
+            uint32_t bits = bitpack_width(block, bitpack_block_size);
+
+            size_t size = v.size();
+            v.resize(size + 1u + bitpack_bytes(bits));
+            v[size] = static_cast<uint8_t>(bits);
+
+            bitpack128(block, v.data() + size + 1u, bits);
+        }
+
+        varint_append(v, x + blocks * bitpack_block_size, n - blocks * bitpack_block_size);
+    }
+
+    // Reads n values written by bitpack_append from the size bytes at src
+    // returns the number of bytes read, or 0 if src is truncated or invalid
+    inline size_t bitpack_decode(const uint8_t* src, size_t size, uint32_t* dst, size_t n)
+    {
+        size_t blocks = n / bitpack_block_size;
+        size_t position = 0;
+
+        for (size_t i = 0; i != blocks; ++i)
+        {
+            if (position == size || src[position] > 32)
+            {
+                return 0;
+            }
+
+            uint32_t bits = src[position];
+
+            if (size - position - 1u < bitpack_bytes(bits))
+            {
+                return 0;
+            }
+
+            bitunpack128(src + position + 1u, dst + i * bitpack_block_size, bits);
+            position += 1u + bitpack_bytes(bits);
+        }
+
+        size_t tail = n - blocks * bitpack_block_size;
+
+        if (tail == 0)
+        {
+            return position;
+        }
+
+        size_t read = varint_decode(src + position, size - position, dst + blocks * bitpack_block_size, tail);
+
+        return (read == 0) ? 0 : position + read;
+    }
+}
+
+#endif
@@ -0,0 +1,410 @@
+// k13
+// Kyle J Burgess
+
+#include "byteswap_file.h"
+#include "bytes.h"
+#include "pod_vector.h"
+
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define K13_BYTESWAP_FILE_POSIX
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <cstdio>
+#include <filesystem>
+#endif
+
+namespace k13
+{
+    namespace
+    {
+    #if defined K13_BYTESWAP_FILE_POSIX
+        // File opened for positioned reads or writes
+        class impl_file
+        {
+        public:
+
+            impl_file(const std::string& path, bool write)
+                : m_fd(write
+                    ? ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644)
+                    : ::open(path.c_str(), O_RDONLY))
+            {
+                if (m_fd < 0)
+                {
+                    throw std::runtime_error("byteswap_file could not open " + path);
+                }
+
+            #if defined(POSIX_FADV_SEQUENTIAL)
+                if (!write)
+                {
+                    ::posix_fadvise(m_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+                }
+            #endif
+            }
+
+            impl_file(const impl_file&) = delete;
+
+            impl_file& operator=(const impl_file&) = delete;
+
+            ~impl_file()
+            {
+                ::close(m_fd);
+            }
+
+            // True if path names this file
+            bool same_file(const std::string& path) const
+            {
+                struct stat a {};
+                struct stat b {};
+
+                return ::fstat(m_fd, &a) == 0 &&
+                    ::stat(path.c_str(), &b) == 0 &&
+                    a.st_dev == b.st_dev &&
+                    a.st_ino == b.st_ino;
+            }
+
+            // Read up to size bytes at offset, returns the number read, which is less only at the end of the file
+            size_t read(uint8_t* dst, size_t size, uint64_t offset)
+            {
+                size_t done = 0;
+
+                while (done != size)
+                {
+                    ssize_t n = ::pread(m_fd, dst + done, size - done, static_cast<off_t>(offset + done));
+
+                    if (n < 0)
+                    {
+                        if (errno == EINTR)
+                        {
+                            continue;
+                        }
+
+                        throw std::runtime_error("byteswap_file could not read the source file");
+                    }
+
+                    if (n == 0)
+                    {
+                        break;
+                    }
+
+                    done += static_cast<size_t>(n);
+                }
+
+                return done;
+            }
+
+            // Write size bytes at offset
+            void write(const uint8_t* src, size_t size, uint64_t offset)
+            {
+                size_t done = 0;
+
+                while (done != size)
+                {
+                    ssize_t n = ::pwrite(m_fd, src + done, size - done, static_cast<off_t>(offset + done));
+
+                    if (n < 0)
+                    {
+                        if (errno == EINTR)
+                        {
+                            continue;
+                        }
+
+                        throw std::runtime_error("byteswap_file could not write the destination file");
+                    }
+
+                    done += static_cast<size_t>(n);
+                }
+            }
+
+        protected:
+
+            int m_fd;
+        };
+    #else
+        // File opened for sequential reads or writes
+        // blocks are read and written in order, so offsets are implied
+        class impl_file
+        {
+        public:
+
+            impl_file(const std::string& path, bool write)
+                : m_path(path)
+                , m_file(std::fopen(path.c_str(), write ? "wb" : "rb"))
+            {
+                if (m_file == nullptr)
+                {
+                    throw std::runtime_error("byteswap_file could not open " + path);
+                }
+            }
+
+            impl_file(const impl_file&) = delete;
+
+            impl_file& operator=(const impl_file&) = delete;
+
+            ~impl_file()
+            {
+                std::fclose(m_file);
+            }
+
+            // True if path names this file
+            bool same_file(const std::string& path) const
+            {
+                std::error_code error;
+                return std::filesystem::equivalent(m_path, path, error);
+            }
+
+            // Read up to size bytes, returns the number read, which is less only at the end of the file
+            size_t read(uint8_t* dst, size_t size, uint64_t)
+            {
+                size_t n = std::fread(dst, 1, size, m_file);
+
+                if (n != size && std::ferror(m_file))
+                {
+                    throw std::runtime_error("byteswap_file could not read the source file");
+                }
+
+                return n;
+            }
+
+            // Write size bytes
+            void write(const uint8_t* src, size_t size, uint64_t)
+            {
+                if (std::fwrite(src, 1, size, m_file) != size)
+                {
+                    throw std::runtime_error("byteswap_file could not write the destination file");
+                }
+            }
+
+        protected:
+
+            std::string m_path;
+            FILE* m_file;
+        };
+    #endif
+
+        // Byteswap a block of whole elements in place
+        void impl_byteswap_block(uint8_t* data, size_t size, size_t element_size)
+        {
+            switch (element_size)
+            {
+                case 2:
+                    byteswap(reinterpret_cast<uint16_t*>(data), size / 2u);
+                    break;
+                case 4:
+                    byteswap(reinterpret_cast<uint32_t*>(data), size / 4u);
+                    break;
+                case 8:
+                    byteswap(reinterpret_cast<uint64_t*>(data), size / 8u);
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        // One block of the ring
+        struct impl_block
+        {
+            pod_vector<uint8_t> data;
+            size_t size = 0;
+            uint64_t offset = 0;
+            thread_task task;
+        };
+    }
+
+    uint64_t byteswap_file(
+        const std::string& src_path,
+        const std::string& dst_path,
+        size_t element_size,
+        thread_pool& pool,
+        size_t block_size,
+        size_t block_count)
+    {
+        if (element_size != 1 && element_size != 2 && element_size != 4 && element_size != 8)
+        {
+            throw std::runtime_error("byteswap_file element size must be 1, 2, 4 or 8");
+        }
+
+        // Blocks hold whole elements
+        block_size -= block_size % element_size;
+
+        if (block_size == 0 || block_count == 0)
+        {
+            throw std::runtime_error("byteswap_file requires at least one block of one element");
+        }
+
+        impl_file src(src_path, false);
+
+        // Opening the destination truncates it, which would empty the source
+        if (src.same_file(dst_path))
+        {
+            throw std::runtime_error("byteswap_file source and destination are the same file");
+        }
+
+        impl_file dst(dst_path, true);
+
+        std::vector<impl_block> blocks(block_count);
+        for (auto& block : blocks)
+        {
+            block.data.resize(block_size);
+        }
+
+        // Ring state, blocks [blocks_written, blocks_read) are being swapped or written
+        std::mutex mtx;
+        std::condition_variable cv;
+        size_t blocks_read = 0;
+        size_t blocks_written = 0;
+        bool reading = true;
+        bool failed = false;
+        std::exception_ptr write_error;
+
+        // The writer writes each block once it is swapped, in order,
+        // while this thread reads the blocks after it
+        std::thread writer([&]()
+        {
+            try
+            {
+                for (size_t i = 0;; ++i)
+                {
+                    {
+                        std::unique_lock<std::mutex> lock(mtx);
+                        cv.wait(lock, [&]() { return i < blocks_read || !reading || failed; });
+
+                        if (i == blocks_read || failed)
+                        {
+                            return;
+                        }
+                    }
+
+                    impl_block& block = blocks[i % block_count];
+
+                    block.task.wait();
+                    dst.write(block.data.data(), block.size, block.offset);
+
+                    {
+                        std::lock_guard<std::mutex> lock(mtx);
+                        blocks_written = i + 1u;
+                    }
+
+                    cv.notify_all();
+                }
+            }
+            catch (...)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mtx);
+                    write_error = std::current_exception();
+                    failed = true;
+                }
+
+                cv.notify_all();
+            }
+        });
+
+        uint64_t offset = 0;
+        std::exception_ptr read_error;
+
+        try
+        {
+            for (size_t i = 0;; ++i)
+            {
+                // Wait for the writer to free the block
+                {
+                    std::unique_lock<std::mutex> lock(mtx);
+                    cv.wait(lock, [&]() { return i - blocks_written < block_count || failed; });
+
+                    if (failed)
+                    {
+                        break;
+                    }
+                }
+
+                impl_block& block = blocks[i % block_count];
+
+                block.size = src.read(block.data.data(), block_size, offset);
+                block.offset = offset;
+
+                if (block.size == 0)
+                {
+                    break;
+                }
+
+                if (block.size % element_size != 0)
+                {
+                    throw std::runtime_error("byteswap_file source size is not a multiple of the element size");
+                }
+
+                uint8_t* data = block.data.data();
+                size_t size = block.size;
+
+                pool.run(block.task, [data, size, element_size]()
+                {
+                    impl_byteswap_block(data, size, element_size);
+                });
+
+                offset += block.size;
+
+                {
+                    std::lock_guard<std::mutex> lock(mtx);
+                    blocks_read = i + 1u;
+                }
+
+                cv.notify_all();
+
+                if (block.size != block_size)
+                {
+                    break;
+                }
+            }
+        }
+        catch (...)
+        {
+            read_error = std::current_exception();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            reading = false;
+            failed = failed || (read_error != nullptr);
+        }
+
+        cv.notify_all();
+        writer.join();
+
+        // Workers may still hold blocks, let them finish before the ring is freed
+        for (auto& block : blocks)
+        {
+            try
+            {
+                block.task.wait();
+            }
+            catch (...)
+            {
+                if (read_error == nullptr && write_error == nullptr)
+                {
+                    read_error = std::current_exception();
+                }
+            }
+        }
+
+        if (read_error != nullptr)
+        {
+            std::rethrow_exception(read_error);
+        }
+
+        if (write_error != nullptr)
+        {
+            std::rethrow_exception(write_error);
+        }
+
+        return offset;
+    }
+}
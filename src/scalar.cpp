@@ -3,8 +3,8 @@
 
 #include "scalar.h"
 
-#include <sstream>
-#include <iomanip>
+#include <charconv>
+#include <ostream>
 
 namespace k13
 {
@@ -268,24 +268,207 @@ namespace k13
         return *this;
     }
 
+    std::string scalar_t::to_string() const
+    {
+        char buffer[max_chars];
+        auto r = to_chars(buffer, buffer + max_chars);
+
+        return std::string(buffer, r.ptr);
+    }
+
     std::string scalar_t::to_string(int precision) const
+    {
+        // Digits, plus sign, point and exponent
+        std::string s(static_cast<size_t>((precision > 0) ? precision : 0) + 32u, '\0');
+        auto r = to_chars(s.data(), s.data() + s.size(), precision);
+
+        s.resize(static_cast<size_t>(r.ptr - s.data()));
+        return s;
+    }
+
+    std::to_chars_result scalar_t::to_chars(char* first, char* last) const
     {
         switch(m_type)
         {
             case type_real:
-                {
-                    std::stringstream ss;
-                    ss  << std::setprecision(precision)
-                        << m_data.real_val;
-                    return ss.str();
-                }
+                return std::to_chars(first, last, m_data.real_val);
             case type_int:
-                return std::to_string(m_data.int_val);
+                return std::to_chars(first, last, m_data.int_val);
             default:
                 throw std::runtime_error("scalar_t unsupported type");
         }
     }
 
+    std::to_chars_result scalar_t::to_chars(char* first, char* last, int precision) const
+    {
+        switch(m_type)
+        {
+            case type_real:
+                return std::to_chars(first, last, m_data.real_val, std::chars_format::general, precision);
+            case type_int:
+                return std::to_chars(first, last, m_data.int_val);
+            default:
+                throw std::runtime_error("scalar_t unsupported type");
+        }
+    }
+
+    void scalar_t::append_chars(pod_vector<char>& buffer) const
+    {
+        size_t size = buffer.size();
+        buffer.resize(size + max_chars);
+
+        auto r = to_chars(buffer.data() + size, buffer.data() + size + max_chars);
+        buffer.resize(static_cast<size_t>(r.ptr - buffer.data()));
+    }
+
+    void scalar_t::append_chars(const scalar_t* values, size_t n, char delimiter, pod_vector<char>& buffer)
+    {
+        size_t size = buffer.size();
+        buffer.resize(size + n * (max_chars + 1u));
+
+        char* p = buffer.data() + size;
+        char* last = buffer.data() + buffer.size();
+
+        for (size_t i = 0; i != n; ++i)
+        {
+            if (i != 0)
+            {
+                *p++ = delimiter;
+            }
+
+            p = values[i].to_chars(p, last).ptr;
+        }
+
+        buffer.resize(static_cast<size_t>(p - buffer.data()));
+    }
+
+    std::optional<scalar_t> scalar_t::parse(std::string_view s)
+    {
+        const char* first = s.data();
+        const char* last = first + s.size();
+
+        while (first != last && (*first == ' ' || *first == '\t'))
+        {
+            ++first;
+        }
+
+        while (last != first && (last[-1] == ' ' || last[-1] == '\t'))
+        {
+            --last;
+        }
+
+        scalar_t x;
+
+        if (first == last || impl_parse(first, last, x) != last)
+        {
+            return std::nullopt;
+        }
+
+        return x;
+    }
+
+    scalar_parse_result scalar_t::parse(std::string_view text, char delimiter, pod_vector<scalar_t>& values)
+    {
+        scalar_parse_result result;
+
+        const char* begin = text.data();
+        const char* end = begin + text.size();
+        const char* p = begin;
+
+        auto is_space = [delimiter](char c)
+        {
+            return (c == ' ' || c == '\t') && c != delimiter;
+        };
+
+        // A delimiter was just read, so another field must follow on the same line
+        bool expect_field = false;
+
+        while (true)
+        {
+            while (p != end && is_space(*p))
+            {
+                ++p;
+            }
+
+            if (p == end || *p == '\n' || *p == '\r')
+            {
+                if (expect_field)
+                {
+                    result.error = static_cast<size_t>(p - begin);
+                    break;
+                }
+
+                if (p == end)
+                {
+                    break;
+                }
+
+                ++p;
+                continue;
+            }
+
+            scalar_t x;
+            const char* next = impl_parse(p, end, x);
+
+            while (next != end && is_space(*next))
+            {
+                ++next;
+            }
+
+            if (next == p || (next != end && *next != delimiter && *next != '\n' && *next != '\r'))
+            {
+                result.error = static_cast<size_t>(p - begin);
+                break;
+            }
+
+            values.push_back(x);
+            ++result.count;
+
+            expect_field = (next != end && *next == delimiter);
+            p = expect_field ? (next + 1) : next;
+        }
+
+        return result;
+    }
+
+    const char* scalar_t::impl_parse(const char* first, const char* last, scalar_t& x)
+    {
+        // from_chars does not accept a leading plus
+        const char* p = first;
+
+        if (p != last && *p == '+')
+        {
+            ++p;
+
+            if (p == last || *p == '-')
+            {
+                return first;
+            }
+        }
+
+        // Integers are read once, and anything that stops at a fraction or exponent,
+        // or does not fit in int64, is read again as a double
+        int_t i;
+        auto r = std::from_chars(p, last, i);
+
+        if (r.ec == std::errc() && (r.ptr == last || (*r.ptr != '.' && *r.ptr != 'e' && *r.ptr != 'E')))
+        {
+            x = i;
+            return r.ptr;
+        }
+
+        real_t d;
+        auto rd = std::from_chars(p, last, d);
+
+        if (rd.ec != std::errc())
+        {
+            return first;
+        }
+
+        x = d;
+        return rd.ptr;
+    }
+
     bool scalar_t::is_floating_point() const
     {
         return m_type == type_real;
@@ -81,6 +81,13 @@ namespace k13
 
         if (!m_threads.empty())
         {
+            // Mark the task in progress before it can be picked up,
+            // so that wait() blocks until it has completed
+            sync->mtx.lock();
+            sync->status = thread_task_progress;
+            sync->exception = nullptr;
+            sync->mtx.unlock();
+
             std::lock_guard<std::mutex> lock(m_queue_mtx);
 
             // Add task to queue
@@ -98,7 +105,7 @@ namespace k13
 
                 // Tell main thread that the task has been processed
                 sync->mtx.lock();
-                sync->status = thread_task_complete;
+                sync->status = sync->exception ? thread_task_error : thread_task_complete;
 
                 // Manual unlocking is done before notifying, to avoid waking up
                 // the waiting thread only to block again (see notify_one for details)
@@ -115,6 +122,11 @@ namespace k13
         }
     }
 
+    size_t thread_pool::size() const
+    {
+        return m_threads.size();
+    }
+
     void thread_pool::thread_loop()
     {
         while (m_running)
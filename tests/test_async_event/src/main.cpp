@@ -0,0 +1,230 @@
+// k13
+// Kyle J Burgess
+
+#include "async_event.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+int main()
+{
+    k13::thread_pool pool(4, std::chrono::milliseconds(1));
+    k13::async_event<int, std::string> e(pool);
+
+    // ordered delivery per subscriber
+    std::vector<int> a, b;
+    std::atomic<int> once { 0 };
+
+    e.add_callback([&a](const int& x, const std::string& s)
+    {
+        if (s == std::to_string(x))
+        {
+            a.push_back(x);
+        }
+        return k13::persist_callback;
+    });
+
+    auto connection = e.add_callback([&b](const int& x, const std::string&)
+    {
+        b.push_back(x);
+        return k13::persist_callback;
+    });
+
+    e.add_callback([&once](const int&, const std::string&)
+    {
+        ++once;
+        return k13::remove_callback;
+    });
+
+    // batched delivery
+    std::vector<int> batched;
+    size_t batches = 0;
+
+    e.add_batch_callback([&](k13::pod_span<const std::tuple<int, std::string>> span)
+    {
+        ++batches;
+        for (const auto& args : span)
+        {
+            batched.push_back(std::get<0>(args));
+        }
+        return k13::persist_callback;
+    });
+
+    for (int i = 0; i != 1000; ++i)
+    {
+        e.invoke(i, std::to_string(i));
+
+        if (i == 499)
+        {
+            e.flush();
+            connection.disconnect();
+        }
+    }
+
+    e.flush();
+
+    if (a.size() != 1000 || b.size() != 500 || batched.size() != 1000 || once != 1)
+    {
+        return -1;
+    }
+
+    for (int i = 0; i != 1000; ++i)
+    {
+        if (a[i] != i || batched[i] != i || (i < 500 && b[i] != i))
+        {
+            return -1;
+        }
+    }
+
+    if (batches == 0 || batches > 1000 || connection.connected())
+    {
+        return -1;
+    }
+
+    // exceptions are reported by flush
+    k13::async_event<int> f(pool);
+    f.add_callback([](const int& x) -> k13::callback_persistence
+    {
+        if (x == 3)
+        {
+            throw std::runtime_error("test");
+        }
+        return k13::persist_callback;
+    });
+
+    for (int i = 0; i != 5; ++i)
+    {
+        f.invoke(i);
+    }
+
+    try
+    {
+        f.flush();
+        return -1;
+    }
+    catch (const std::runtime_error&)
+    {}
+
+    // a subscriber that throws still receives the rest of its messages
+    {
+        k13::thread_pool single(1, std::chrono::milliseconds(1));
+        k13::async_event<int> g(single);
+
+        std::vector<int> received;
+        g.add_callback([&received](const int& x) -> k13::callback_persistence
+        {
+            received.push_back(x);
+
+            if (x == 1)
+            {
+                throw std::runtime_error("test");
+            }
+            return k13::persist_callback;
+        });
+
+        // Hold the only thread, so all three messages are delivered as one batch
+        std::atomic<bool> hold { true };
+        k13::thread_task blocker;
+        single.run(blocker, [&hold]()
+        {
+            while (hold)
+            {
+                std::this_thread::yield();
+            }
+        });
+
+        g.invoke(1);
+        g.invoke(2);
+        g.invoke(3);
+
+        hold = false;
+
+        bool thrown = false;
+
+        try
+        {
+            g.flush();
+        }
+        catch (const std::runtime_error&)
+        {
+            thrown = true;
+        }
+
+        if (!thrown || received != std::vector<int>({ 1, 2, 3 }))
+        {
+            return -1;
+        }
+
+        blocker.wait();
+    }
+
+    // subscribers may call back into the event when the pool delivers inline
+    {
+        k13::thread_pool inline_pool(0, std::chrono::milliseconds(1));
+        k13::async_event<int> h(inline_pool);
+
+        std::vector<int> received;
+        k13::event_connection self;
+
+        self = h.add_callback([&](const int& x)
+        {
+            received.push_back(x);
+
+            if (x == 1)
+            {
+                h.invoke(2);
+                h.add_callback([&received](const int& y)
+                {
+                    received.push_back(y * 10);
+                    return k13::persist_callback;
+                });
+                self.disconnect();
+            }
+            return k13::persist_callback;
+        });
+
+        h.invoke(1);
+        h.invoke(3);
+        h.flush();
+
+        if (received != std::vector<int>({ 1, 30 }))
+        {
+            return -1;
+        }
+    }
+
+    // the destructor waits for a delivery in flight to a disconnected subscriber
+    {
+        std::atomic<bool> started { false };
+        std::atomic<bool> done { false };
+
+        auto d = std::make_unique<k13::async_event<int>>(pool);
+        auto connection_d = d->add_callback([&](const int&)
+        {
+            started = true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            done = true;
+            return k13::persist_callback;
+        });
+
+        d->invoke(0);
+
+        while (!started)
+        {
+            std::this_thread::yield();
+        }
+
+        connection_d.disconnect();
+        d.reset();
+
+        if (!done)
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
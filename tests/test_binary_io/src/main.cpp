@@ -0,0 +1,122 @@
+// k13
+// Kyle J Burgess
+
+#include "binary_io.h"
+
+#include <cstdint>
+#include <cstring>
+
+#pragma pack(push, 1)
+struct Header
+{
+    uint8_t magic[4];
+    uint8_t length[2];
+};
+#pragma pack(pop)
+
+int main()
+{
+    // write a message in big endian
+    k13::pod_vector<uint8_t> buffer;
+
+    {
+        auto w = k13::binary_writer::append(buffer, 4 + 2 + 4 + 8 + 8 + 1);
+
+        w.write<uint8_t>('K');
+        w.write<uint8_t>('1');
+        w.write<uint8_t>('3');
+        w.write<uint8_t>('!');
+        w.write<uint16_t, k13::big_endian>(0x0102);
+        w.write<int32_t, k13::big_endian>(-2);
+        w.write<double, k13::big_endian>(1.5);
+        w.write<uint64_t, k13::little_endian>(0x0102030405060708ull);
+        w.write<uint8_t>(7);
+
+        if (w.remaining() != 0)
+        {
+            return -1;
+        }
+    }
+
+    if (buffer.size() != 27 || buffer[4] != 0x01 || buffer[5] != 0x02 || buffer[6] != 0xff || buffer[9] != 0xfe || buffer[18] != 0x08)
+    {
+        return -1;
+    }
+
+    // read it back
+    k13::binary_reader r(buffer);
+
+    if (!r.can_read(27) || r.can_read(28))
+    {
+        return -1;
+    }
+
+    auto message = r.take(27);
+
+    auto header = message.view<Header>();
+    if (memcmp(header->magic, "K13!", 4) != 0 || header->length[0] != 0x01 || header->length[1] != 0x02)
+    {
+        return -1;
+    }
+
+    if (message.read<int32_t, k13::big_endian>() != -2 || message.read<double, k13::big_endian>() != 1.5)
+    {
+        return -1;
+    }
+
+    if (message.read<uint64_t, k13::little_endian>() != 0x0102030405060708ull || message.read<uint8_t>() != 7 || message.remaining() != 0)
+    {
+        return -1;
+    }
+
+    // reading past the end is caught once per message
+    try
+    {
+        r.take(1);
+        return -1;
+    }
+    catch (const std::runtime_error&)
+    {}
+
+    // arrays at unaligned offsets
+    uint32_t values[100];
+    for (uint32_t i = 0; i != 100; ++i)
+    {
+        values[i] = i * 0x01020304u;
+    }
+
+    k13::pod_vector<uint8_t> array_buffer;
+    {
+        auto w = k13::binary_writer::append(array_buffer, 1 + sizeof(values));
+        w.write<uint8_t>(0);
+        w.write<uint32_t, k13::big_endian>(values, 100);
+    }
+
+    if (array_buffer[1 + 4 * 1] != 0x01 || array_buffer[1 + 4 * 1 + 3] != 0x04)
+    {
+        return -1;
+    }
+
+    k13::binary_reader ar(array_buffer);
+    ar.skip(1);
+
+    uint32_t copy[100];
+    ar.read<uint32_t, k13::big_endian>(copy, 100);
+
+    if (memcmp(copy, values, sizeof(values)) != 0)
+    {
+        return -1;
+    }
+
+    // native order skips the swap
+    ar.seek(1);
+    uint32_t swapped = ar.read<uint32_t>();
+    ar.seek(5);
+
+    if (swapped != 0 || k13::byteswap(ar.read<uint32_t>()) != values[1])
+    {
+        return -1;
+    }
+
+    return 0;
+}
@@ -6,6 +6,7 @@
 #include <iostream>
 #include <cstdint>
 #include <cstring>
+#include <vector>
 
 template<class T>
 bool test_byteswap()
@@ -53,8 +54,229 @@ bool test_byteswap()
     return true;
 }
 
+// 3 and 6 byte packed integers
+struct uint24
+{
+    uint8_t bytes[3];
+};
+
+struct uint48
+{
+    uint8_t bytes[6];
+};
+
+// Checks that byteswap reverses the first Size bytes of a T, for types of any size
+template<class T, size_t Size = sizeof(T)>
+bool test_byteswap_bytes()
+{
+    uint8_t a[sizeof(T)] = {};
+    uint8_t b[sizeof(T)] = {};
+
+    for (size_t i = 0; i != Size; ++i)
+    {
+        a[i] = static_cast<uint8_t>(i + 1u);
+    }
+
+    T x;
+    memcpy(&x, a, sizeof(T));
+
+    T y = k13::byteswap(x);
+    memcpy(b, &y, sizeof(T));
+
+    for (size_t i = 0; i != Size; ++i)
+    {
+        if (b[sizeof(T) - 1u - i] != a[i])
+        {
+            return false;
+        }
+    }
+
+    // and back
+    T z = k13::byteswap(y);
+
+    return memcmp(&z, a, Size) == 0;
+}
+
+#if defined(K13_BIT_CAST_SUPPORT) && defined(K13_INT128_SUPPORT)
+static_assert(k13::byteswap(static_cast<unsigned __int128>(1)) == static_cast<unsigned __int128>(1) << 120u, "constexpr byteswap<unsigned __int128>");
+#endif
+
+#ifdef K13_BIT_CAST_SUPPORT
+// byteswap folds at compile time
+static_assert(k13::byteswap(uint16_t(0x0102u)) == 0x0201u, "constexpr byteswap<uint16_t>");
+static_assert(k13::byteswap(uint32_t(0x01020304u)) == 0x04030201u, "constexpr byteswap<uint32_t>");
+static_assert(k13::byteswap(uint64_t(0x0102030405060708ull)) == 0x0807060504030201ull, "constexpr byteswap<uint64_t>");
+static_assert(k13::byteswap(int32_t(-2)) == int32_t(0xfeffffffu), "constexpr byteswap<int32_t>");
+static_assert(k13::byteswap(k13::byteswap(1.5f)) == 1.5f, "constexpr byteswap<float>");
+static_assert(k13::byteswap(k13::byteswap(-0.25)) == -0.25, "constexpr byteswap<double>");
+static_assert(k13::byteswap(uint24{ { 1, 2, 3 } }).bytes[0] == 3, "constexpr byteswap<uint24>");
+#endif
+
+// Byteswap one element at a time
+template<class T>
+void reference_byteswap(T* dst, const T* src, size_t n)
+{
+    for (size_t i = 0; i != n; ++i)
+    {
+        dst[i] = k13::byteswap(src[i]);
+    }
+}
+
+template<class T>
+bool test_byteswap_large()
+{
+    // offset by up to 8 elements, so every vector head and tail case is covered
+    for (size_t offset = 0; offset != 9; ++offset)
+    {
+        for (size_t n : { 0u, 1u, 3u, 7u, 15u, 16u, 17u, 31u, 33u, 63u, 65u, 127u, 255u, 257u, 4095u })
+        {
+            std::vector<T> src(n + 9), dst(n + 9), expected(n + 9);
+
+            auto bytes = reinterpret_cast<uint8_t*>(src.data());
+            for (size_t i = 0; i != src.size() * sizeof(T); ++i)
+            {
+                bytes[i] = static_cast<uint8_t>(i * 31u + 7u);
+            }
+
+            reference_byteswap(expected.data() + offset, src.data() + offset, n);
+
+            // out of place
+            k13::byteswap(dst.data() + offset, src.data() + offset, n);
+
+            if (memcmp(dst.data() + offset, expected.data() + offset, n * sizeof(T)) != 0)
+            {
+                return false;
+            }
+
+            // in place
+            k13::byteswap(src.data() + offset, n);
+
+            if (memcmp(src.data() + offset, expected.data() + offset, n * sizeof(T)) != 0)
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+// Byteswap arrays of T, checking the reversed bytes in memory, where no T value is copied
+template<class T>
+bool test_byteswap_memory()
+{
+    for (size_t n : { 0u, 1u, 2u, 3u, 17u, 100u })
+    {
+        std::vector<T> src(n), dst(n);
+        std::vector<uint8_t> expected(n * sizeof(T));
+
+        auto bytes = reinterpret_cast<uint8_t*>(src.data());
+        for (size_t i = 0; i != n * sizeof(T); ++i)
+        {
+            bytes[i] = static_cast<uint8_t>(i * 31u + 7u);
+        }
+
+        for (size_t i = 0; i != n * sizeof(T); ++i)
+        {
+            size_t element = i / sizeof(T);
+            expected[i] = bytes[element * sizeof(T) + sizeof(T) - 1u - i % sizeof(T)];
+        }
+
+        // out of place
+        k13::byteswap(dst.data(), src.data(), n);
+
+        if (n != 0 && memcmp(dst.data(), expected.data(), n * sizeof(T)) != 0)
+        {
+            return false;
+        }
+
+        // in place
+        k13::byteswap(src.data(), n);
+
+        if (n != 0 && memcmp(src.data(), expected.data(), n * sizeof(T)) != 0)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+#ifdef K13_X86_SIMD_DISPATCH
+// Checks one shuffle kernel against a byte by byte permutation
+bool test_shuffle_kernel(k13::impl_shuffle_func kernel)
+{
+    const uint8_t* mask = k13::impl_byteswap_mask<4>::value;
+
+    std::vector<uint8_t> src(1000), dst(1000), expected(1000);
+    for (size_t i = 0; i != src.size(); ++i)
+    {
+        src[i] = static_cast<uint8_t>(i);
+    }
+
+    for (size_t bytes = 0; bytes <= 600; bytes += 7)
+    {
+        std::fill(dst.begin(), dst.end(), 0);
+        size_t done = kernel(dst.data() + 1, src.data() + 3, bytes, mask);
+
+        if (done != (bytes & ~size_t(15)))
+        {
+            return false;
+        }
+
+        for (size_t i = 0; i != done; ++i)
+        {
+            if (dst[1 + i] != src[3 + (i & ~size_t(15)) + mask[i & 15u]])
+            {
+                return false;
+            }
+        }
+
+        // nothing written past the blocks
+        if (dst[1 + done] != 0)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+#endif
+
 int main()
 {
+#ifdef K13_X86_SIMD_DISPATCH
+    // simd kernels this cpu supports
+
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("ssse3") && !test_shuffle_kernel(&k13::impl_shuffle_bytes_ssse3))
+    {
+        std::cout << "failed test_shuffle_kernel(ssse3)\n";
+        return -1;
+    }
+
+    if (__builtin_cpu_supports("avx2") && !test_shuffle_kernel(&k13::impl_shuffle_bytes_avx2))
+    {
+        std::cout << "failed test_shuffle_kernel(avx2)\n";
+        return -1;
+    }
+
+    if (__builtin_cpu_supports("avx512bw") && !test_shuffle_kernel(&k13::impl_shuffle_bytes_avx512))
+    {
+        std::cout << "failed test_shuffle_kernel(avx512)\n";
+        return -1;
+    }
+#endif
+
+    // large and unaligned arrays
+
+    if (!test_byteswap_large<uint16_t>() || !test_byteswap_large<uint32_t>() || !test_byteswap_large<uint64_t>() || !test_byteswap_large<double>())
+    {
+        std::cout << "failed test_byteswap_large()\n";
+        return -1;
+    }
+
     // reverse tests
 
     if (!test_byteswap<uint8_t>())
@@ -117,5 +339,34 @@ int main()
         return -1;
     }
 
+#ifdef K13_INT128_SUPPORT
+    if (!test_byteswap<unsigned __int128>() || !test_byteswap<__int128>() || !test_byteswap_large<unsigned __int128>())
+    {
+        std::cout << "failed test_byteswap<__int128>()\n";
+        return -1;
+    }
+#endif
+
+    // other sizes
+
+    if (!test_byteswap_bytes<uint24>() || !test_byteswap_large<uint24>())
+    {
+        std::cout << "failed test_byteswap<uint24>()\n";
+        return -1;
+    }
+
+    if (!test_byteswap_bytes<uint48>() || !test_byteswap_large<uint48>())
+    {
+        std::cout << "failed test_byteswap<uint48>()\n";
+        return -1;
+    }
+
+    // long double is only swapped in memory, since x87 padding bytes need not survive a copy
+    if (!test_byteswap_memory<long double>())
+    {
+        std::cout << "failed test_byteswap<long double>()\n";
+        return -1;
+    }
+
     return 0;
 }
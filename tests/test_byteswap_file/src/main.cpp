@@ -0,0 +1,198 @@
+// k13
+// Kyle J Burgess
+
+#include "byteswap_file.h"
+#include "bytes.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+static const char* src_path = "test_byteswap_file_src.bin";
+static const char* dst_path = "test_byteswap_file_dst.bin";
+
+// Write bytes to a file
+bool write_file(const char* path, const void* data, size_t size)
+{
+    FILE* f = std::fopen(path, "wb");
+
+    if (f == nullptr)
+    {
+        return false;
+    }
+
+    bool ok = size == 0 || std::fwrite(data, 1, size, f) == size;
+    std::fclose(f);
+
+    return ok;
+}
+
+// Read a whole file
+std::vector<uint8_t> read_file(const char* path)
+{
+    std::vector<uint8_t> data;
+    FILE* f = std::fopen(path, "rb");
+
+    if (f != nullptr)
+    {
+        uint8_t buffer[4096];
+        size_t n;
+
+        while ((n = std::fread(buffer, 1, sizeof(buffer), f)) != 0)
+        {
+            data.insert(data.end(), buffer, buffer + n);
+        }
+
+        std::fclose(f);
+    }
+
+    return data;
+}
+
+// Convert n T through the file pipeline, and compare with byteswap
+template<class T>
+bool test_convert(k13::thread_pool& pool, size_t n, size_t block_size, size_t block_count)
+{
+    std::vector<T> values(n);
+    for (size_t i = 0; i != n; ++i)
+    {
+        values[i] = static_cast<T>(i * 0x0102030405060708ull + 0x1122334455667788ull);
+    }
+
+    if (!write_file(src_path, values.data(), n * sizeof(T)))
+    {
+        return false;
+    }
+
+    uint64_t converted = k13::byteswap_file(src_path, dst_path, sizeof(T), pool, block_size, block_count);
+
+    if (converted != n * sizeof(T))
+    {
+        return false;
+    }
+
+    std::vector<uint8_t> result = read_file(dst_path);
+
+    if (result.size() != n * sizeof(T))
+    {
+        return false;
+    }
+
+    k13::byteswap(values.data(), n);
+
+    return n == 0 || memcmp(result.data(), values.data(), result.size()) == 0;
+}
+
+int main()
+{
+    k13::thread_pool pool(2, std::chrono::milliseconds(1));
+    k13::thread_pool inline_pool(0, std::chrono::milliseconds(1));
+
+    // files smaller than, equal to, and many times one block, with partial last blocks
+    if (!test_convert<uint32_t>(pool, 0, 4096, 3) ||
+        !test_convert<uint32_t>(pool, 1, 4096, 3) ||
+        !test_convert<uint32_t>(pool, 1024, 4096, 3) ||
+        !test_convert<uint32_t>(pool, 100003, 4096, 3) ||
+        !test_convert<uint16_t>(pool, 100003, 1000, 2) ||
+        !test_convert<uint64_t>(pool, 65536, 1 << 16, 4) ||
+        !test_convert<uint64_t>(pool, 5000, 4096, 1) ||
+        !test_convert<uint8_t>(pool, 5000, 4096, 2) ||
+        !test_convert<uint32_t>(inline_pool, 100003, 4096, 3))
+    {
+        return -1;
+    }
+
+    // block sizes are rounded down to whole elements
+    if (!test_convert<uint64_t>(pool, 1000, 4100, 2))
+    {
+        return -1;
+    }
+
+    // a file that is not a whole number of elements
+    {
+        uint8_t bytes[7] = {};
+        write_file(src_path, bytes, sizeof(bytes));
+
+        bool thrown = false;
+
+        try
+        {
+            k13::byteswap_file(src_path, dst_path, 4, pool, 4096, 2);
+        }
+        catch (const std::runtime_error&)
+        {
+            thrown = true;
+        }
+
+        if (!thrown)
+        {
+            return -1;
+        }
+    }
+
+    // invalid arguments, and a missing source
+    {
+        int thrown = 0;
+
+        try
+        {
+            k13::byteswap_file(src_path, dst_path, 3, pool);
+        }
+        catch (const std::runtime_error&)
+        {
+            ++thrown;
+        }
+
+        try
+        {
+            k13::byteswap_file(src_path, dst_path, 8, pool, 4, 2);
+        }
+        catch (const std::runtime_error&)
+        {
+            ++thrown;
+        }
+
+        try
+        {
+            k13::byteswap_file("test_byteswap_file_missing.bin", dst_path, 4, pool);
+        }
+        catch (const std::runtime_error&)
+        {
+            ++thrown;
+        }
+
+        if (thrown != 3)
+        {
+            return -1;
+        }
+    }
+
+    // the source as its own destination is rejected, and left unchanged
+    {
+        uint32_t values[4] = { 1, 2, 3, 4 };
+        write_file(src_path, values, sizeof(values));
+
+        bool thrown = false;
+
+        try
+        {
+            k13::byteswap_file(src_path, src_path, 4, pool);
+        }
+        catch (const std::runtime_error&)
+        {
+            thrown = true;
+        }
+
+        if (!thrown || read_file(src_path).size() != sizeof(values))
+        {
+            return -1;
+        }
+    }
+
+    std::remove(src_path);
+    std::remove(dst_path);
+
+    return 0;
+}
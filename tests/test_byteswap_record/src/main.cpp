@@ -0,0 +1,322 @@
+// k13
+// Kyle J Burgess
+
+#include "byteswap_record.h"
+
+#include <cstdint>
+#include <cstring>
+
+// 16 bytes of mixed widths, swapped with one shuffle mask
+struct Mixed
+{
+    uint32_t a;
+    uint16_t b;
+    int16_t c;
+    uint64_t d;
+};
+
+// 12 bytes of one width, swapped as an array of uint32_t
+struct Uniform
+{
+    uint32_t x;
+    float y;
+    int32_t z;
+};
+
+// 4 bytes with a byte field and padding
+struct Tagged
+{
+    uint16_t value;
+    uint8_t tag;
+};
+
+// 12 bytes with padding and an array field, swapped with three masks per 48 bytes
+struct Irregular
+{
+    uint32_t a;
+    uint8_t b;
+    uint16_t c[3];
+};
+
+// Nested record
+struct Nested
+{
+    Uniform u;
+    double t;
+};
+
+// 24 bytes of mixed widths and padding
+struct Wide
+{
+    uint32_t a;
+    uint16_t b;
+    uint16_t c;
+    uint64_t d;
+    uint32_t e;
+};
+
+// 3 byte scalar
+struct uint24
+{
+    uint8_t bytes[3];
+};
+
+// 7 bytes, whose 3 byte fields cross 16 byte blocks in an array
+struct Sample
+{
+    uint24 a;
+    uint8_t tag;
+    uint24 b;
+};
+
+enum class Kind : uint8_t
+{
+    none,
+    some,
+};
+
+// bool and enum fields, which may only hold their valid values
+struct Flags
+{
+    uint32_t id;
+    bool enabled;
+    Kind kind;
+    uint16_t count;
+};
+
+// Only a is declared, so b is never swapped
+struct Partial
+{
+    uint32_t a;
+    uint32_t b;
+};
+
+// Larger than the 256 bytes that have shuffle masks
+struct Large
+{
+    uint32_t v[80];
+};
+
+// Larger than 256 bytes, and not uniform
+struct LargeMixed
+{
+    uint64_t a;
+    uint16_t b[150];
+    uint8_t c[4];
+};
+
+K13_RECORD_FIELDS(Mixed, &Mixed::a, &Mixed::b, &Mixed::c, &Mixed::d)
+K13_RECORD_FIELDS(Uniform, &Uniform::x, &Uniform::y, &Uniform::z)
+K13_RECORD_FIELDS(Tagged, &Tagged::value, &Tagged::tag)
+K13_RECORD_FIELDS(Irregular, &Irregular::a, &Irregular::b, &Irregular::c)
+K13_RECORD_FIELDS(Nested, &Nested::u, &Nested::t)
+K13_RECORD_FIELDS(Wide, &Wide::a, &Wide::b, &Wide::c, &Wide::d, &Wide::e)
+K13_RECORD_FIELDS(Sample, &Sample::a, &Sample::tag, &Sample::b)
+K13_RECORD_FIELDS(Flags, &Flags::id, &Flags::enabled, &Flags::kind, &Flags::count)
+K13_RECORD_FIELDS(Partial, &Partial::a)
+K13_RECORD_FIELDS(Large, &Large::v)
+K13_RECORD_FIELDS(LargeMixed, &LargeMixed::a, &LargeMixed::b)
+
+// Fill records with distinct bytes
+template<class T>
+void fill(T* x, size_t n)
+{
+    auto bytes = reinterpret_cast<uint8_t*>(x);
+
+    for (size_t i = 0; i != n * sizeof(T); ++i)
+    {
+        bytes[i] = static_cast<uint8_t>(i * 7u + 1u);
+    }
+}
+
+// Compare byteswap_records against byteswap_record on every array size up to 64
+template<class T>
+bool test_bulk()
+{
+    constexpr size_t max = 64;
+
+    T expected[max];
+    T actual[max];
+    T copied[max];
+
+    for (size_t n = 0; n <= max; ++n)
+    {
+        fill(expected, max);
+        fill(actual, max);
+
+        for (size_t i = 0; i != n; ++i)
+        {
+            k13::byteswap_record(expected[i]);
+        }
+
+        k13::byteswap_records(actual, n);
+
+        if (memcmp(expected, actual, sizeof(expected)) != 0)
+        {
+            return false;
+        }
+
+        fill(actual, max);
+        fill(copied, max);
+        k13::byteswap_records(copied, actual, n);
+
+        if (memcmp(expected, copied, n * sizeof(T)) != 0)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main()
+{
+    // single record
+    {
+        Mixed m = { 0x01020304u, 0x0506u, 0x0708, 0x090a0b0c0d0e0f10ull };
+        k13::byteswap_record(m);
+
+        if (m.a != 0x04030201u || m.b != 0x0605u || m.c != 0x0807 || m.d != 0x100f0e0d0c0b0a09ull)
+        {
+            return -1;
+        }
+    }
+
+    {
+        Irregular r = { 0x01020304u, 0x05, { 0x0607u, 0x0809u, 0x0a0bu } };
+        k13::byteswap_record(r);
+
+        if (r.a != 0x04030201u || r.b != 0x05 || r.c[0] != 0x0706u || r.c[1] != 0x0908u || r.c[2] != 0x0b0au)
+        {
+            return -1;
+        }
+    }
+
+    {
+        Nested r = { { 0x01020304u, 1.0f, -2 }, 0.5 };
+        k13::byteswap_record(r);
+        k13::byteswap_record(r);
+
+        if (r.u.x != 0x01020304u || r.u.y != 1.0f || r.u.z != -2 || r.t != 0.5)
+        {
+            return -1;
+        }
+
+        k13::byteswap_record(r);
+
+        if (r.u.x != 0x04030201u || r.u.z != k13::byteswap(int32_t(-2)) || r.t == 0.5)
+        {
+            return -1;
+        }
+    }
+
+    // bulk paths
+    if (k13::impl_record_layout<Mixed>::get().width != 0 || !k13::impl_record_layout<Mixed>::get().has_masks)
+    {
+        return -1;
+    }
+
+    if (k13::impl_record_layout<Uniform>::get().width != 4)
+    {
+        return -1;
+    }
+
+    if (k13::impl_record_layout<Tagged>::get().width != 0 || !k13::impl_record_layout<Tagged>::get().has_masks)
+    {
+        return -1;
+    }
+
+    if (k13::impl_record_layout<Irregular>::get().width != 0 || !k13::impl_record_layout<Irregular>::get().has_masks ||
+        k13::impl_record_layout<Irregular>::period != 48 || !k13::impl_record_layout<Irregular>::get().crossing.empty())
+    {
+        return -1;
+    }
+
+    if (k13::impl_record_layout<Sample>::period != 112 || k13::impl_record_layout<Sample>::get().crossing.empty())
+    {
+        return -1;
+    }
+
+    if (k13::impl_record_layout<Partial>::get().width != 0 || !k13::impl_record_layout<Partial>::get().has_masks)
+    {
+        return -1;
+    }
+
+    if (k13::impl_record_layout<Large>::get().width != 4 || k13::impl_record_layout<LargeMixed>::get().width != 0 ||
+        k13::impl_record_layout<LargeMixed>::get().has_masks)
+    {
+        return -1;
+    }
+
+    if (!test_bulk<Mixed>() || !test_bulk<Uniform>() || !test_bulk<Tagged>() || !test_bulk<Irregular>() ||
+        !test_bulk<Nested>() || !test_bulk<Wide>() || !test_bulk<Sample>() || !test_bulk<Partial>() ||
+        !test_bulk<Large>() || !test_bulk<LargeMixed>())
+    {
+        return -1;
+    }
+
+    // undeclared bytes are not swapped
+    {
+        Partial p[4];
+
+        for (auto& r : p)
+        {
+            r = { 0x11223344u, 0x55667788u };
+        }
+
+        k13::byteswap_records(p, 4);
+
+        for (const auto& r : p)
+        {
+            if (r.a != 0x44332211u || r.b != 0x55667788u)
+            {
+                return -1;
+            }
+        }
+    }
+
+    // bool and enum fields keep valid values
+    {
+        Flags expected[40];
+        Flags actual[40];
+
+        for (size_t i = 0; i != 40; ++i)
+        {
+            expected[i] = { static_cast<uint32_t>(i * 0x01020304u), (i % 3) == 0, (i % 2) ? Kind::some : Kind::none, static_cast<uint16_t>(i * 0x0101u) };
+            actual[i] = expected[i];
+            k13::byteswap_record(expected[i]);
+        }
+
+        k13::byteswap_records(actual, 40);
+
+        for (size_t i = 0; i != 40; ++i)
+        {
+            if (actual[i].id != expected[i].id || actual[i].enabled != expected[i].enabled ||
+                actual[i].kind != expected[i].kind || actual[i].count != expected[i].count)
+            {
+                return -1;
+            }
+        }
+    }
+
+    // pod_vector
+    {
+        k13::pod_vector<Mixed> v(100);
+        fill(v.data(), v.size());
+
+        Mixed first = v[0];
+        Mixed last = v[99];
+
+        k13::byteswap_records(v);
+
+        k13::byteswap_record(first);
+        k13::byteswap_record(last);
+
+        if (memcmp(&v[0], &first, sizeof(Mixed)) != 0 || memcmp(&v[99], &last, sizeof(Mixed)) != 0)
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
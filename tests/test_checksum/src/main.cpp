@@ -0,0 +1,193 @@
+// k13
+// Kyle J Burgess
+
+#include "checksum.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Bit at a time CRC-32C
+uint32_t reference_crc32c(const uint8_t* data, size_t size)
+{
+    uint32_t crc = ~uint32_t(0);
+
+    for (size_t i = 0; i != size; ++i)
+    {
+        crc ^= data[i];
+
+        for (size_t bit = 0; bit != 8; ++bit)
+        {
+            crc = (crc & 1u) ? ((crc >> 1u) ^ 0x82f63b78u) : (crc >> 1u);
+        }
+    }
+
+    return ~crc;
+}
+
+// Checks a crc kernel against the reference at every length and alignment
+bool test_kernel(k13::impl_crc32c_func kernel, const std::vector<uint8_t>& data)
+{
+    for (size_t offset = 0; offset != 8; ++offset)
+    {
+        for (size_t size : { 0u, 1u, 7u, 8u, 9u, 63u, 64u, 1535u, 1536u, 1537u, 3072u, 4000u, 10000u })
+        {
+            if (~kernel(~uint32_t(0), data.data() + offset, size) != reference_crc32c(data.data() + offset, size))
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+int main()
+{
+    std::vector<uint8_t> data(20000);
+
+    uint64_t state = 13;
+    for (auto& b : data)
+    {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        b = static_cast<uint8_t>(state >> 56u);
+    }
+
+    // check values
+    {
+        const char* digits = "123456789";
+
+        if (k13::crc32c(digits, 9) != 0xe3069283u || reference_crc32c(reinterpret_cast<const uint8_t*>(digits), 9) != 0xe3069283u)
+        {
+            return -1;
+        }
+
+        uint8_t zeros[32] = {};
+        if (k13::crc32c(zeros, 32) != 0x8a9136aau || k13::crc32c(zeros, 0) != 0)
+        {
+            return -1;
+        }
+    }
+
+    // kernels
+    if (!test_kernel(&k13::impl_crc32c_table, data))
+    {
+        return -1;
+    }
+
+#ifdef K13_CRC32C_DISPATCH
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("sse4.2") && !test_kernel(&k13::impl_crc32c_sse42, data))
+    {
+        return -1;
+    }
+
+    if (__builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("pclmul") && !test_kernel(&k13::impl_crc32c_sse42_pclmul, data))
+    {
+        return -1;
+    }
+#endif
+
+    // continuation
+    {
+        uint32_t whole = k13::crc32c(data.data(), data.size());
+
+        for (size_t split : { 0u, 1u, 100u, 1536u, 19999u, 20000u })
+        {
+            uint32_t crc = k13::crc32c(data.data(), split);
+            crc = k13::crc32c(data.data() + split, data.size() - split, crc);
+
+            if (crc != whole)
+            {
+                return -1;
+            }
+        }
+    }
+
+    // hash
+    {
+        // every length hashes differently, including zero padding
+        std::vector<uint64_t> hashes;
+        uint8_t zeros[200] = {};
+
+        for (size_t size = 0; size != 200; ++size)
+        {
+            hashes.push_back(k13::hash64(zeros, size));
+
+            if (size != 0)
+            {
+                hashes.push_back(k13::hash64(data.data(), size));
+            }
+        }
+
+        for (size_t i = 0; i != hashes.size(); ++i)
+        {
+            for (size_t j = i + 1u; j != hashes.size(); ++j)
+            {
+                if (hashes[i] == hashes[j])
+                {
+                    return -1;
+                }
+            }
+        }
+
+        // deterministic, and seeded
+        if (k13::hash64(data.data(), 1000) != k13::hash64(data.data(), 1000) ||
+            k13::hash64(data.data(), 1000, 1) == k13::hash64(data.data(), 1000, 2))
+        {
+            return -1;
+        }
+
+        // flipping any input bit flips about half the output bits
+        for (size_t size : { 8u, 16u, 17u, 64u, 65u, 300u })
+        {
+            std::vector<uint8_t> input(data.begin(), data.begin() + static_cast<std::ptrdiff_t>(size));
+            uint64_t h = k13::hash64(input.data(), size);
+
+            size_t flips = 0;
+            for (size_t bit = 0; bit != size * 8u; ++bit)
+            {
+                input[bit / 8u] ^= static_cast<uint8_t>(1u << (bit % 8u));
+                flips += static_cast<size_t>(k13::impl_popcount(h ^ k13::hash64(input.data(), size)));
+                input[bit / 8u] ^= static_cast<uint8_t>(1u << (bit % 8u));
+            }
+
+            double mean = static_cast<double>(flips) / static_cast<double>(size * 8u);
+            if (mean < 30.0 || mean > 34.0)
+            {
+                return -1;
+            }
+        }
+    }
+
+    // fused byteswap and crc
+    {
+        size_t n = 10001;
+
+        std::vector<uint32_t> src(n), dst(n), expected(n);
+        memcpy(src.data(), data.data(), n * sizeof(uint32_t) > data.size() ? data.size() : n * sizeof(uint32_t));
+
+        k13::byteswap(expected.data(), src.data(), n);
+        uint32_t crc = k13::crc32c(expected.data(), n * sizeof(uint32_t));
+
+        if (k13::byteswap_crc32c(dst.data(), src.data(), n) != crc || dst != expected)
+        {
+            return -1;
+        }
+
+        if (k13::byteswap_crc32c(src.data(), n) != crc || src != expected)
+        {
+            return -1;
+        }
+
+        // continuing from an earlier crc
+        uint32_t head = k13::crc32c("k13", 3);
+        if (k13::byteswap_crc32c(dst.data(), expected.data(), n, head) != k13::crc32c(dst.data(), n * sizeof(uint32_t), head))
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
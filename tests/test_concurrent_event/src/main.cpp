@@ -0,0 +1,281 @@
+// k13
+// Kyle J Burgess
+
+#include "concurrent_event.h"
+#include "thread_pool.h"
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+struct Object
+{
+    std::atomic<int> calls { 0 };
+
+    k13::callback_persistence on_event(int x)
+    {
+        calls += x;
+        return k13::persist_callback;
+    }
+};
+
+int main()
+{
+    k13::concurrent_event<int> e;
+
+    // single thread
+    std::atomic<int> a { 0 };
+    std::atomic<int> once { 0 };
+
+    size_t id = e.add_callback([&a](int x)
+    {
+        a += x;
+        return k13::persist_callback;
+    });
+
+    e.add_callback([&once](int)
+    {
+        ++once;
+        return k13::remove_callback;
+    });
+
+    auto object = std::make_shared<Object>();
+    e.add_callback(object, &Object::on_event);
+
+    e.invoke(2);
+    e.invoke(3);
+
+    if (a != 5 || once != 1 || object->calls != 5)
+    {
+        return -1;
+    }
+
+    // expired objects remove their callback
+    object.reset();
+    e.invoke(1);
+    e.compact();
+
+    if (a != 6 || e.size() != 1)
+    {
+        return -1;
+    }
+
+    if (!e.unsubscribe(id) || e.unsubscribe(id))
+    {
+        return -1;
+    }
+
+    e.invoke(1);
+
+    if (a != 6 || e.size() != 0)
+    {
+        return -1;
+    }
+
+    // subscribing from inside invoke
+    std::atomic<int> nested { 0 };
+    e.add_callback([&e, &nested](int)
+    {
+        e.add_callback([&nested](int)
+        {
+            ++nested;
+            return k13::remove_callback;
+        });
+
+        return k13::remove_callback;
+    });
+
+    e.invoke(0);
+    e.invoke(0);
+
+    if (nested != 1)
+    {
+        return -1;
+    }
+
+    // invoke from many threads while subscribing and unsubscribing
+    k13::concurrent_event<int> shared;
+    std::atomic<long> total { 0 };
+
+    shared.add_callback([&total](int x)
+    {
+        total += x;
+        return k13::persist_callback;
+    });
+
+    const size_t num_tasks = 4;
+    const int per_task = 20000;
+
+    k13::thread_pool pool(num_tasks, std::chrono::milliseconds(1));
+    k13::thread_task tasks[num_tasks];
+
+    for (auto& task : tasks)
+    {
+        pool.run(task, [&shared, per_task]()
+        {
+            for (int i = 0; i != per_task; ++i)
+            {
+                shared.invoke(1);
+            }
+        });
+    }
+
+    std::atomic<long> churn { 0 };
+    for (int i = 0; i != 200; ++i)
+    {
+        size_t sub = shared.add_callback([&churn](int x)
+        {
+            churn += x;
+            return k13::persist_callback;
+        });
+
+        shared.unsubscribe(sub);
+    }
+
+    for (auto& task : tasks)
+    {
+        task.wait();
+    }
+
+    if (total != static_cast<long>(num_tasks) * per_task)
+    {
+        return -1;
+    }
+
+    // many writers at once, whose grace periods must not interleave
+    {
+        k13::concurrent_event<int> e;
+        std::atomic<long> count { 0 };
+        std::atomic<bool> writing { true };
+
+        e.add_callback([&count](int x)
+        {
+            count += x;
+            return k13::persist_callback;
+        });
+
+        const size_t num_readers = 2;
+        const size_t num_writers = 3;
+
+        k13::thread_task readers[num_readers];
+        k13::thread_task writers[num_writers];
+
+        for (auto& task : readers)
+        {
+            pool.run(task, [&e, &writing]()
+            {
+                while (writing)
+                {
+                    e.invoke(1);
+                }
+            });
+        }
+
+        std::atomic<size_t> writers_done { 0 };
+
+        for (auto& task : writers)
+        {
+            pool.run(task, [&e, &writers_done]()
+            {
+                for (int i = 0; i != 500; ++i)
+                {
+                    size_t sub = e.add_callback([](int)
+                    {
+                        return k13::persist_callback;
+                    });
+
+                    e.unsubscribe(sub);
+                }
+
+                ++writers_done;
+            });
+        }
+
+        while (writers_done != num_writers)
+        {
+            std::this_thread::yield();
+        }
+
+        writing = false;
+
+        for (auto& task : readers)
+        {
+            task.wait();
+        }
+
+        for (auto& task : writers)
+        {
+            task.wait();
+        }
+
+        e.compact();
+
+        if (e.size() != 1 || count == 0)
+        {
+            return -1;
+        }
+    }
+
+    // a callback that throws still ends its read, so later writers on other threads finish
+    {
+        k13::concurrent_event<int> e;
+
+        e.add_callback([](int x) -> k13::callback_persistence
+        {
+            if (x == 1)
+            {
+                throw std::runtime_error("callback failed");
+            }
+
+            return k13::persist_callback;
+        });
+
+        bool caught = false;
+        try
+        {
+            e.invoke(1);
+        }
+        catch (const std::runtime_error&)
+        {
+            caught = true;
+        }
+
+        if (!caught)
+        {
+            return -1;
+        }
+
+        std::atomic<bool> done { false };
+
+        std::thread writer([&e, &done]()
+        {
+            size_t sub = e.add_callback([](int)
+            {
+                return k13::persist_callback;
+            });
+
+            e.unsubscribe(sub);
+            done = true;
+        });
+
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (!done && std::chrono::steady_clock::now() < deadline)
+        {
+            std::this_thread::yield();
+        }
+
+        if (!done)
+        {
+            // the writer is stuck in its grace period, and can't be joined
+            writer.detach();
+            return -1;
+        }
+
+        writer.join();
+
+        e.invoke(2);
+    }
+
+    return 0;
+}
@@ -0,0 +1,137 @@
+// k13
+// Kyle J Burgess
+
+#include "concurrent_pod_vector.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+int main()
+{
+    // single thread
+    {
+        k13::concurrent_pod_vector<uint32_t, 2> v;
+
+        for (uint32_t i = 0; i != 100; ++i)
+        {
+            if (v.push_back(i) != i)
+            {
+                return -1;
+            }
+        }
+
+        if (v.published() != 100 || v[0] != 0 || v[99] != 99)
+        {
+            return -1;
+        }
+
+        // a reserved but uncommitted range holds back the snapshot
+        size_t first = v.reserve_range(10);
+        uint32_t tail[3] = { 1, 2, 3 };
+        v.push_back(tail, 3);
+
+        if (first != 100 || v.reserved() != 113 || v.published() != 100)
+        {
+            return -1;
+        }
+
+        for (size_t i = 0; i != 10; ++i)
+        {
+            v[first + i] = 7;
+        }
+        v.commit(first, 10);
+
+        if (v.published() != 113 || v[105] != 7 || v[112] != 3)
+        {
+            return -1;
+        }
+
+        std::vector<uint32_t> out(v.published());
+        v.copy(out.data(), out.size());
+
+        for (uint32_t i = 0; i != 100; ++i)
+        {
+            if (out[i] != i)
+            {
+                return -1;
+            }
+        }
+
+        v.clear();
+
+        if (v.published() != 0)
+        {
+            return -1;
+        }
+    }
+
+    // many writers
+    {
+        const size_t num_tasks = 8;
+        const size_t per_task = 20000;
+
+        k13::concurrent_pod_vector<uint64_t> v;
+        k13::thread_pool pool(4, std::chrono::milliseconds(1));
+        std::vector<k13::thread_task> tasks(num_tasks);
+
+        for (size_t t = 0; t != num_tasks; ++t)
+        {
+            pool.run(tasks[t], [&v, t, per_task]()
+            {
+                uint64_t batch[7];
+
+                for (size_t i = 0; i < per_task; i += 7)
+                {
+                    size_t n = std::min<size_t>(7, per_task - i);
+
+                    for (size_t j = 0; j != n; ++j)
+                    {
+                        batch[j] = t * per_task + i + j;
+                    }
+
+                    v.push_back(batch, n);
+                }
+            });
+        }
+
+        // snapshots only grow while writers run
+        size_t last = 0;
+        for (int i = 0; i != 100; ++i)
+        {
+            size_t n = v.published();
+
+            if (n < last)
+            {
+                return -1;
+            }
+
+            last = n;
+        }
+
+        for (auto& task : tasks)
+        {
+            task.wait();
+        }
+
+        if (v.published() != num_tasks * per_task)
+        {
+            return -1;
+        }
+
+        std::vector<uint64_t> out(v.published());
+        v.copy(out.data(), out.size());
+        std::sort(out.begin(), out.end());
+
+        for (size_t i = 0; i != out.size(); ++i)
+        {
+            if (out[i] != i)
+            {
+                return -1;
+            }
+        }
+    }
+
+    return 0;
+}
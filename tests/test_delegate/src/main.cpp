@@ -0,0 +1,176 @@
+// k13
+// Kyle J Burgess
+
+#include "delegate.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+int add(int x, int y)
+{
+    return x + y;
+}
+
+struct Accumulator
+{
+    int total = 0;
+
+    int add(int x, int y)
+    {
+        total += x + y;
+        return total;
+    }
+
+    int get(int x, int y) const
+    {
+        return total + x - y;
+    }
+};
+
+int main()
+{
+    using delegate_t = k13::delegate<int(int, int)>;
+
+    // empty
+    delegate_t empty;
+    delegate_t null_func = static_cast<int(*)(int, int)>(nullptr);
+
+    if (empty || null_func)
+    {
+        return -1;
+    }
+
+    // free function
+    delegate_t f = add;
+
+    if (!f || f(2, 3) != 5)
+    {
+        return -1;
+    }
+
+    // member functions
+    Accumulator acc;
+    auto m = delegate_t::bind(&acc, &Accumulator::add);
+    auto c = delegate_t::bind(static_cast<const Accumulator*>(&acc), &Accumulator::get);
+
+    m(1, 2);
+    m(3, 4);
+
+    if (acc.total != 10 || c(5, 1) != 14)
+    {
+        return -1;
+    }
+
+    // stateful lambda with a non-trivial capture
+    auto counter = std::make_shared<int>(0);
+    delegate_t l = [counter](int x, int y)
+    {
+        *counter += x * y;
+        return *counter;
+    };
+
+    if (l(2, 3) != 6 || counter.use_count() != 2)
+    {
+        return -1;
+    }
+
+    // copies share no state with the original callable
+    delegate_t l2 = l;
+
+    if (counter.use_count() != 3 || l2(1, 1) != 7)
+    {
+        return -1;
+    }
+
+    // moves leave the source empty
+    delegate_t l3 = std::move(l2);
+
+    if (l2 || !l3 || counter.use_count() != 3)
+    {
+        return -1;
+    }
+
+    l3 = f;
+
+    if (counter.use_count() != 2 || l3(1, 1) != 2)
+    {
+        return -1;
+    }
+
+    // contiguous storage
+    std::vector<delegate_t> delegates;
+    for (int i = 0; i != 100; ++i)
+    {
+        delegates.push_back([i](int x, int y) { return i + x + y; });
+        delegates.push_back(l);
+    }
+
+    int sum = 0;
+    for (auto& d : delegates)
+    {
+        sum += d(0, 0) > 0 ? 1 : 0;
+    }
+
+    if (sum != 199 || counter.use_count() != 102)
+    {
+        return -1;
+    }
+
+    delegates.clear();
+    l = nullptr;
+
+    if (counter.use_count() != 1)
+    {
+        return -1;
+    }
+
+    // callables up to 32 bytes are stored inline, larger ones on the heap
+    {
+        struct fits
+        {
+            void* p[4];
+            int operator()(int x, int y) const { return x + y; }
+        };
+
+        struct too_large
+        {
+            void* p[5];
+            int operator()(int x, int y) const { return x + y; }
+        };
+
+        static_assert(delegate_t::storage_size == 4 * sizeof(void*), "delegate inline storage");
+        static_assert(delegate_t::stores_inline<fits>, "32 byte callables are stored inline");
+        static_assert(!delegate_t::stores_inline<too_large>, "larger callables are stored on the heap");
+
+        std::string name = "a name longer than the small string buffer";
+        auto large = [name, counter](int x, int y)
+        {
+            return static_cast<int>(name.size()) + x + y + *counter;
+        };
+
+        static_assert(!delegate_t::stores_inline<decltype(large)>, "a std::string and a pointer do not fit inline");
+
+        delegate_t h = large;
+        delegate_t h2 = h;
+        delegate_t h3 = std::move(h2);
+
+        int expected = static_cast<int>(name.size()) + *counter;
+
+        if (h(1, 2) != expected + 3 || h2 || h3(0, 0) != expected ||
+            counter.use_count() != 4 || delegate_t(too_large())(2, 2) != 4)
+        {
+            return -1;
+        }
+
+        h = nullptr;
+        h3 = f;
+
+        if (counter.use_count() != 2)
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
@@ -3,6 +3,10 @@
 
 #include "event.h"
 
+#include <string>
+#include <utility>
+#include <vector>
+
 k13::callback_persistence compute_something(int& r, int x, int y)
 {
     r = x;
@@ -15,6 +19,25 @@ k13::callback_persistence compute_something(int& r, int x, int y)
     return k13::persist_callback;
 }
 
+// Counts copies made of it
+struct Counted
+{
+    static inline int copies = 0;
+
+    Counted() = default;
+
+    Counted(const Counted&)
+    {
+        ++copies;
+    }
+
+    Counted& operator=(const Counted&)
+    {
+        ++copies;
+        return *this;
+    }
+};
+
 struct Object
 {
     int x;
@@ -102,5 +125,415 @@ int main()
         }
     }
 
+    // disconnect with connection handles
+    int calls = 0;
+    auto eventE = std::make_shared<k13::event<int&>>();
+    auto connection = eventE->add_callback([&calls](int& x)
+    {
+        ++calls;
+        x += 1;
+        return k13::persist_callback;
+    });
+
+    int rE = 0;
+    eventE->invoke(rE);
+
+    if (!connection.connected() || calls != 1)
+    {
+        return -1;
+    }
+
+    connection.disconnect();
+    eventE->invoke(rE);
+
+    if (connection.connected() || calls != 1 || eventE->size() != 0)
+    {
+        return -1;
+    }
+
+    // many one-shot subscribers
+    for (int i = 0; i != 1000; ++i)
+    {
+        eventE->add_callback([](int& x)
+        {
+            ++x;
+            return k13::remove_callback;
+        });
+    }
+
+    rE = 0;
+    eventE->invoke(rE);
+    eventE->invoke(rE);
+
+    if (rE != 1000 || eventE->size() != 0)
+    {
+        return -1;
+    }
+
+    // subscribe and unsubscribe during invoke
+    k13::event_connection other;
+    int nested = 0;
+
+    eventE->add_callback([&](int& x)
+    {
+        // disconnect a later subscriber, and subscribe a new one
+        other.disconnect();
+
+        eventE->add_callback([&nested](int&)
+        {
+            nested += 10;
+            return k13::persist_callback;
+        });
+
+        ++x;
+        return k13::remove_callback;
+    });
+
+    other = eventE->add_callback([&nested](int&)
+    {
+        ++nested;
+        return k13::persist_callback;
+    });
+
+    rE = 0;
+    eventE->invoke(rE);
+
+    if (rE != 1 || nested != 0 || eventE->size() != 1)
+    {
+        return -1;
+    }
+
+    eventE->invoke(rE);
+
+    if (rE != 1 || nested != 10)
+    {
+        return -1;
+    }
+
+    // a callback that disconnects itself and then asks to be removed, directly and through a forward
+    for (bool forwarded : { false, true })
+    {
+        auto source = std::make_shared<k13::event<int&>>();
+        auto target = std::make_shared<k13::event<int&>>();
+
+        if (forwarded)
+        {
+            source->forward(target);
+        }
+
+        auto& e = forwarded ? *target : *source;
+
+        k13::event_connection self;
+        self = e.add_callback([&self](int& x)
+        {
+            self.disconnect();
+            ++x;
+            return k13::remove_callback;
+        });
+
+        auto kept = e.add_callback([](int& x)
+        {
+            x += 10;
+            return k13::persist_callback;
+        });
+
+        int r = 0;
+        source->invoke(r);
+        source->invoke(r);
+
+        if (r != 21 || self.connected() || !kept.connected() || e.size() != 1)
+        {
+            return -1;
+        }
+
+        // freed slots are reused once
+        auto a = e.add_callback([](int&) { return k13::persist_callback; });
+        auto b = e.add_callback([](int&) { return k13::persist_callback; });
+
+        if (!a.connected() || !b.connected() || e.size() != 3)
+        {
+            return -1;
+        }
+
+        a.disconnect();
+
+        if (!b.connected() || e.size() != 2)
+        {
+            return -1;
+        }
+    }
+
+    // callbacks too large for inline storage, such as a std::string and a pointer
+    {
+        k13::event<int&> e;
+        std::string text = "a capture longer than the small string buffer";
+        int* target = nullptr;
+
+        e.add_callback([text, target](int& x)
+        {
+            x += static_cast<int>(text.size()) + (target == nullptr ? 1 : 0);
+            return k13::persist_callback;
+        });
+
+        int r = 0;
+        e.invoke(r);
+
+        if (r != static_cast<int>(text.size()) + 1)
+        {
+            return -1;
+        }
+    }
+
+    // connections outliving the event
+    auto connection2 = eventE->add_callback([](int&) { return k13::persist_callback; });
+    eventE.reset();
+
+    if (connection2.connected())
+    {
+        return -1;
+    }
+
+    connection2.disconnect();
+
+    // arguments are delivered without copies
+    int received = 0;
+    k13::event<Counted> eventF;
+
+    for (int i = 0; i != 10; ++i)
+    {
+        eventF.add_callback([&received](const Counted&)
+        {
+            ++received;
+            return k13::persist_callback;
+        });
+    }
+
+    eventF.invoke(Counted());
+
+    if (received != 10 || Counted::copies != 0)
+    {
+        return -1;
+    }
+
+    // non-owning member subscription
+    Object local { 10, 20 };
+    k13::event<int&> eventG;
+    auto connection3 = eventG.add_callback(&local, &Object::compute_something);
+
+    int rG = 0;
+    eventG.invoke(rG);
+
+    if (rG != r || !connection3.connected())
+    {
+        return -1;
+    }
+
+    connection3.disconnect();
+    rG = 0;
+    eventG.invoke(rG);
+
+    if (rG != 0)
+    {
+        return -1;
+    }
+
+    // member subscriptions are removed with their object
+    eventG.add_callback(object, &Object::compute_something);
+    object.reset();
+    eventG.invoke(rG);
+
+    if (rG != 0 || eventG.size() != 0)
+    {
+        return -1;
+    }
+
+    // forwarding tree
+    // root -> { a -> { c }, b -> { c } }, a diamond, and a chain root -> chain[0] -> ... -> chain[7]
+    std::vector<std::shared_ptr<k13::event<int&>>> nodes;
+    for (int i = 0; i != 12; ++i)
+    {
+        nodes.push_back(std::make_shared<k13::event<int&>>());
+    }
+
+    auto& root = nodes[0];
+    root->forward(nodes[1]);
+    root->forward(nodes[2]);
+    nodes[1]->forward(nodes[3]);
+    nodes[2]->forward(nodes[3]);
+    root->forward(nodes[4]);
+
+    for (int i = 4; i != 11; ++i)
+    {
+        nodes[i]->forward(nodes[i + 1]);
+    }
+
+    std::vector<int> order;
+    auto subscribe = [&order](k13::event<int&>& e, int id)
+    {
+        return e.add_callback([&order, id](int& x)
+        {
+            order.push_back(id);
+            ++x;
+            return k13::persist_callback;
+        });
+    };
+
+    subscribe(*nodes[3], 3);
+    subscribe(*nodes[1], 1);
+    subscribe(*nodes[11], 11);
+    auto middle = subscribe(*nodes[7], 7);
+
+    int rT = 0;
+    root->invoke(rT);
+
+    if (rT != 5 || order != std::vector<int>({ 3, 1, 3, 11, 7 }))
+    {
+        return -1;
+    }
+
+    // changes in the middle of the tree are seen by the root
+    middle.disconnect();
+    subscribe(*nodes[2], 2);
+    auto leaf = subscribe(*nodes[11], 12);
+
+    order.clear();
+    rT = 0;
+    root->invoke(rT);
+
+    if (rT != 6 || order != std::vector<int>({ 3, 1, 3, 2, 11, 12 }))
+    {
+        return -1;
+    }
+
+    // forward once inside the tree, and a destroyed event in the chain
+    auto once = std::make_shared<k13::event<int&>>();
+    subscribe(*once, 20);
+    nodes[1]->forward_once(once);
+    nodes[8].reset();
+
+    order.clear();
+    root->invoke(rT);
+
+    if (order != std::vector<int>({ 3, 1, 20, 3, 2 }))
+    {
+        return -1;
+    }
+
+    order.clear();
+    root->invoke(rT);
+
+    if (order != std::vector<int>({ 3, 1, 3, 2 }) || !leaf.connected())
+    {
+        return -1;
+    }
+
+    // disconnecting a forward, and subscribing from inside the tree
+    auto forward = root->forward(nodes[9]);
+    subscribe(*nodes[10], 10);
+
+    nodes[3]->add_callback([&](int&)
+    {
+        subscribe(*nodes[9], 9);
+        return k13::remove_callback;
+    });
+
+    order.clear();
+    root->invoke(rT);
+
+    if (order != std::vector<int>({ 3, 1, 3, 2, 11, 12, 10 }))
+    {
+        return -1;
+    }
+
+    order.clear();
+    root->invoke(rT);
+
+    if (order != std::vector<int>({ 3, 1, 3, 2, 11, 12, 10, 9 }))
+    {
+        return -1;
+    }
+
+    forward.disconnect();
+    order.clear();
+    root->invoke(rT);
+
+    if (order != std::vector<int>({ 3, 1, 3, 2 }))
+    {
+        return -1;
+    }
+
+    // invoking a node directly
+    order.clear();
+    nodes[9]->invoke(rT);
+
+    if (order != std::vector<int>({ 11, 12, 10, 9 }))
+    {
+        return -1;
+    }
+
+    // a forwarding cycle calls each event once, from whichever end is invoked
+    {
+        auto a = std::make_shared<k13::event<int&>>();
+        auto b = std::make_shared<k13::event<int&>>();
+        auto c = std::make_shared<k13::event<int&>>();
+
+        subscribe(*a, 1);
+        subscribe(*b, 2);
+        subscribe(*c, 3);
+
+        a->forward(b);
+        b->forward(a);
+        c->forward(a);
+
+        std::vector<std::pair<k13::event<int&>*, std::vector<int>>> invokes =
+        {
+            { b.get(), { 2, 1 } },
+            { a.get(), { 1, 2 } },
+            { c.get(), { 3, 1, 2 } },
+            { b.get(), { 2, 1 } },
+            { a.get(), { 1, 2 } },
+        };
+
+        for (const auto& [e, expected] : invokes)
+        {
+            order.clear();
+            e->invoke(rT);
+
+            if (order != expected)
+            {
+                return -1;
+            }
+        }
+    }
+
+    // empty callbacks are not subscribed
+    {
+        auto e = std::make_shared<k13::event<int&>>();
+        auto target = std::make_shared<k13::event<int&>>();
+
+        k13::callback_persistence (*null_fp)(int&) = nullptr;
+
+        auto empty = e->add_callback(null_fp);
+
+        if (empty.connected() || e->size() != 0)
+        {
+            return -1;
+        }
+
+        empty.disconnect();
+
+        subscribe(*target, 1);
+        e->forward(target);
+        e->add_callback(null_fp);
+
+        order.clear();
+        e->invoke(rT);
+
+        if (order != std::vector<int>({ 1 }) || e->size() != 1)
+        {
+            return -1;
+        }
+    }
+
     return 0;
 }
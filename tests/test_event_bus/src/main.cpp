@@ -0,0 +1,104 @@
+// k13
+// Kyle J Burgess
+
+#include "event_bus.h"
+
+#include <string>
+#include <vector>
+
+int main()
+{
+    k13::event_bus<const std::string&, int> bus;
+
+    std::vector<std::string> log;
+
+    auto record = [&log](const char* who)
+    {
+        return [&log, who](const std::string& text, int x)
+        {
+            log.push_back(std::string(who) + ":" + text + ":" + std::to_string(x));
+            return k13::persist_callback;
+        };
+    };
+
+    // interning
+    auto temperature = bus.intern("sensors/temperature");
+    auto pressure = bus.intern("sensors/pressure");
+
+    if (bus.intern("sensors/temperature") != temperature || temperature == pressure)
+    {
+        return -1;
+    }
+
+    if (bus.find("sensors/temperature") != temperature || bus.find("missing") != bus.npos || bus.name(pressure) != "sensors/pressure")
+    {
+        return -1;
+    }
+
+    // direct and prefix subscriptions
+    bus.subscribe(temperature, record("t"));
+    auto sensors = bus.subscribe_prefix("sensors/", record("s"));
+    bus.subscribe_prefix("", record("all"));
+
+    bus.publish(temperature, "a", 1);
+    bus.publish("sensors/pressure", "b", 2);
+    bus.publish("missing", "c", 3);
+
+    if (log != std::vector<std::string>({ "t:a:1", "s:a:1", "all:a:1", "s:b:2", "all:b:2" }))
+    {
+        return -1;
+    }
+
+    // topics interned after a prefix subscription
+    auto humidity = bus.intern("sensors/humidity");
+    auto other = bus.intern("other");
+
+    log.clear();
+    bus.publish(humidity, "d", 4);
+    bus.publish(other, "e", 5);
+
+    if (log != std::vector<std::string>({ "s:d:4", "all:d:4", "all:e:5" }))
+    {
+        return -1;
+    }
+
+    // unsubscribing a prefix
+    sensors.disconnect();
+
+    log.clear();
+    bus.publish(humidity, "f", 6);
+
+    if (log != std::vector<std::string>({ "all:f:6" }))
+    {
+        return -1;
+    }
+
+    // many topics
+    k13::event_bus<int> big;
+    std::vector<k13::event_bus<int>::topic_id> ids;
+    int sum = 0;
+
+    for (int i = 0; i != 200000; ++i)
+    {
+        ids.push_back(big.intern("topic/" + std::to_string(i)));
+    }
+
+    big.subscribe_prefix("topic/1999", [&sum](int x)
+    {
+        sum += x;
+        return k13::persist_callback;
+    });
+
+    for (auto id : ids)
+    {
+        big.publish(id, 1);
+    }
+
+    // topic/1999, topic/19990 .. topic/19999 and topic/199900 .. topic/199999
+    if (big.size() != 200000 || sum != 111)
+    {
+        return -1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,76 @@
+// k13
+// Kyle J Burgess
+
+#include "event.h"
+
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <thread>
+
+int main()
+{
+    k13::event_profiler::instance().set_trace_capacity(8);
+
+    k13::event<int&> e;
+    e.set_name("tick \"main\"");
+
+    e.add_callback([](int& x)
+    {
+        ++x;
+        return k13::persist_callback;
+    });
+
+    e.add_callback([](int& x)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        ++x;
+        return (x >= 6)
+            ? k13::remove_callback
+            : k13::persist_callback;
+    });
+
+    int x = 0;
+    for (int i = 0; i != 5; ++i)
+    {
+        e.invoke(x);
+    }
+
+    // the second subscriber removed itself on the third invoke
+    const auto& stats = e.stats();
+    if (x != 8 || stats.invokes != 5 || stats.removals != 1 || stats.max_ns < 2000000u || stats.total_ns < 6000000u)
+    {
+        return -1;
+    }
+
+    auto subscribers = e.subscriber_stats();
+    if (subscribers.size() != 1 || subscribers[0].calls != 5 || subscribers[0].slot != 0)
+    {
+        return -1;
+    }
+
+    // trace keeps the most recent calls
+    auto trace = k13::event_profiler::instance().trace();
+    if (trace.size() != 8 || trace.back().slot != 0 || trace[trace.size() - 2].slot != 0)
+    {
+        return -1;
+    }
+
+    std::ostringstream json;
+    k13::event_profiler::instance().export_chrome_trace(json);
+
+    std::string s = json.str();
+    if (s.find("\"traceEvents\"") == std::string::npos || s.find("tick \\\"main\\\"#1") == std::string::npos)
+    {
+        return -1;
+    }
+
+    k13::event_profiler::instance().clear();
+
+    if (!k13::event_profiler::instance().trace().empty())
+    {
+        return -1;
+    }
+
+    return 0;
+}
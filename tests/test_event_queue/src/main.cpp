@@ -0,0 +1,172 @@
+// k13
+// Kyle J Burgess
+
+#include "event_queue.h"
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+int main()
+{
+    // single producer, batched drain
+    {
+        k13::spsc_event_queue<int, std::string> queue(100);
+
+        if (queue.capacity() != 128)
+        {
+            return -1;
+        }
+
+        constexpr int count = 100000;
+        std::thread producer([&queue]()
+        {
+            for (int i = 0; i != count; ++i)
+            {
+                queue.push(i, std::to_string(i));
+            }
+        });
+
+        k13::spsc_event_queue<int, std::string>::batch_event_type batch;
+        int next = 0;
+        bool ordered = true;
+        size_t batches = 0;
+
+        batch.add_callback([&](k13::pod_span<const std::tuple<int, std::string>> span)
+        {
+            ++batches;
+
+            for (const auto& args : span)
+            {
+                ordered = ordered && std::get<0>(args) == next && std::get<1>(args) == std::to_string(next);
+                ++next;
+            }
+
+            return k13::persist_callback;
+        });
+
+        while (next != count)
+        {
+            if (queue.wait(std::chrono::milliseconds(10)))
+            {
+                queue.drain(batch);
+            }
+        }
+
+        producer.join();
+
+        if (!ordered || batches == 0 || batches > static_cast<size_t>(count) || !queue.empty())
+        {
+            return -1;
+        }
+    }
+
+    // multiple producers, drain each
+    {
+        k13::mpsc_event_queue<int, int> queue(64);
+
+        constexpr int producers = 3;
+        constexpr int count = 50000;
+
+        std::vector<std::thread> threads;
+        for (int p = 0; p != producers; ++p)
+        {
+            threads.emplace_back([&queue, p]()
+            {
+                for (int i = 0; i != count; ++i)
+                {
+                    queue.push(p, i);
+                }
+            });
+        }
+
+        k13::event<int, int> each;
+        std::vector<int> next(producers, 0);
+        bool ordered = true;
+        int received = 0;
+
+        each.add_callback([&](int p, int i)
+        {
+            ordered = ordered && next[p] == i;
+            next[p] = i + 1;
+            ++received;
+            return k13::persist_callback;
+        });
+
+        while (received != producers * count)
+        {
+            if (queue.wait(std::chrono::milliseconds(10)))
+            {
+                queue.drain_each(each, 100);
+            }
+        }
+
+        for (auto& t : threads)
+        {
+            t.join();
+        }
+
+        if (!ordered || !queue.empty())
+        {
+            return -1;
+        }
+    }
+
+    // full queue, partial drains and waking
+    {
+        k13::spsc_event_queue<int> queue(4);
+
+        for (int i = 0; i != 4; ++i)
+        {
+            if (!queue.try_push(i))
+            {
+                return -1;
+            }
+        }
+
+        if (queue.try_push(4))
+        {
+            return -1;
+        }
+
+        k13::event<int> each;
+        int sum = 0;
+        each.add_callback([&sum](int x)
+        {
+            sum += x;
+            return k13::persist_callback;
+        });
+
+        if (queue.drain_each(each, 3) != 3 || sum != 3)
+        {
+            return -1;
+        }
+
+        if (!queue.try_push(4) || !queue.try_push(5) || !queue.try_push(6))
+        {
+            return -1;
+        }
+
+        if (queue.drain_each(each) != 4 || sum != 21)
+        {
+            return -1;
+        }
+
+        std::thread waker([&queue]()
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            queue.wake();
+        });
+
+        if (queue.wait(std::chrono::seconds(10)))
+        {
+            return -1;
+        }
+
+        waker.join();
+    }
+
+    return 0;
+}
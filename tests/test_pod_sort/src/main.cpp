@@ -0,0 +1,186 @@
+// k13
+// Kyle J Burgess
+
+#include "pod_sort.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+struct Record
+{
+    uint32_t id;
+    int64_t key;
+};
+
+template<class T>
+std::vector<T> random_values(size_t n, std::mt19937_64& rng)
+{
+    std::vector<T> v(n);
+
+    for (auto& x : v)
+    {
+        if constexpr (std::is_floating_point<T>::value)
+        {
+            x = static_cast<T>(std::uniform_real_distribution<double>(-1e6, 1e6)(rng));
+        }
+        else
+        {
+            x = static_cast<T>(rng());
+        }
+    }
+
+    return v;
+}
+
+template<class T>
+bool test_radix_sort(k13::thread_pool& pool, size_t n, std::mt19937_64& rng)
+{
+    auto expected = random_values<T>(n, rng);
+    auto a = expected;
+    auto b = expected;
+
+    std::sort(expected.begin(), expected.end());
+
+    k13::radix_sort(a.data(), a.size());
+    k13::radix_sort(pool, b.data(), b.size());
+
+    return a == expected && b == expected;
+}
+
+int main()
+{
+    std::mt19937_64 rng(13);
+    k13::thread_pool pool(4, std::chrono::milliseconds(1));
+
+    for (size_t n : { 0, 1, 2, 100, 5000, 100000 })
+    {
+        if (!test_radix_sort<uint8_t>(pool, n, rng) ||
+            !test_radix_sort<uint16_t>(pool, n, rng) ||
+            !test_radix_sort<uint32_t>(pool, n, rng) ||
+            !test_radix_sort<uint64_t>(pool, n, rng) ||
+            !test_radix_sort<int32_t>(pool, n, rng) ||
+            !test_radix_sort<int64_t>(pool, n, rng) ||
+            !test_radix_sort<float>(pool, n, rng) ||
+            !test_radix_sort<double>(pool, n, rng))
+        {
+            return -1;
+        }
+    }
+
+    // records by key, stable
+    std::vector<Record> records(50000);
+    for (size_t i = 0; i != records.size(); ++i)
+    {
+        records[i] = { static_cast<uint32_t>(i), static_cast<int64_t>(rng() % 1000) - 500 };
+    }
+
+    auto expected = records;
+    std::stable_sort(expected.begin(), expected.end(), [](const Record& x, const Record& y) { return x.key < y.key; });
+
+    auto a = records;
+    auto b = records;
+    k13::radix_sort(a.data(), a.size(), [](const Record& r) { return r.key; });
+    k13::radix_sort(pool, b.data(), b.size(), [](const Record& r) { return r.key; });
+
+    for (size_t i = 0; i != expected.size(); ++i)
+    {
+        if (a[i].id != expected[i].id || b[i].id != expected[i].id)
+        {
+            return -1;
+        }
+    }
+
+    // parallel comparison sort
+    auto c = random_values<uint64_t>(100000, rng);
+    auto sorted = c;
+    std::sort(sorted.begin(), sorted.end());
+    k13::parallel_sort(pool, c.data(), c.size());
+
+    if (c != sorted)
+    {
+        return -1;
+    }
+
+    // k-way merge
+    std::vector<int> r0 = { 1, 4, 7 }, r1 = { 2, 5, 8, 9 }, r2 = {}, r3 = { 0, 3, 6 };
+    k13::pod_span<const int> runs[4] =
+    {
+        { r0.data(), r0.size() },
+        { r1.data(), r1.size() },
+        { r2.data(), r2.size() },
+        { r3.data(), r3.size() },
+    };
+
+    int merged[10];
+    k13::kway_merge(runs, 4, merged);
+
+    for (int i = 0; i != 10; ++i)
+    {
+        if (merged[i] != i)
+        {
+            return -1;
+        }
+    }
+
+    // stable partition
+    std::vector<uint32_t> d(100000);
+    for (size_t i = 0; i != d.size(); ++i)
+    {
+        d[i] = static_cast<uint32_t>(i);
+    }
+
+    size_t evens = k13::stable_partition(pool, d.data(), d.size(), [](uint32_t x) { return x % 2 == 0; });
+
+    if (evens != 50000)
+    {
+        return -1;
+    }
+
+    for (size_t i = 0; i != d.size(); ++i)
+    {
+        uint32_t x = (i < evens)
+            ? static_cast<uint32_t>(2 * i)
+            : static_cast<uint32_t>(2 * (i - evens) + 1);
+
+        if (d[i] != x)
+        {
+            return -1;
+        }
+    }
+
+    // a throwing task is rethrown only after every other task has finished
+    {
+        std::atomic<size_t> finished { 0 };
+        bool caught = false;
+
+        try
+        {
+            k13::impl_parallel_for(pool, 8, [&finished](size_t i)
+            {
+                if (i == 0)
+                {
+                    throw std::runtime_error("task failed");
+                }
+
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                ++finished;
+            });
+        }
+        catch (const std::runtime_error&)
+        {
+            caught = true;
+        }
+
+        if (!caught || finished != 7)
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
@@ -20,5 +20,146 @@ int main()
         return -1;
     }
 
+    // parse single values
+    {
+        auto i = k13::scalar_t::parse("-42");
+        auto r = k13::scalar_t::parse(" 2.5e3\t");
+        auto big = k13::scalar_t::parse("99999999999999999999");
+        auto plus = k13::scalar_t::parse("+7");
+        auto inf = k13::scalar_t::parse("-inf");
+
+        if (!i || !i->is_integer() || *i != -42 ||
+            !r || !r->is_floating_point() || *r != 2500.0 ||
+            !big || !big->is_floating_point() || *big != 1e20 ||
+            !plus || !plus->is_integer() || *plus != 7 ||
+            !inf || !inf->is_floating_point() || static_cast<double>(*inf) > -1e308)
+        {
+            return -1;
+        }
+
+        for (const char* bad : { "", " ", "-", "+", "+-1", "1e", "1.5x", "0x10", "1 2", "1e999" })
+        {
+            if (k13::scalar_t::parse(bad))
+            {
+                return -1;
+            }
+        }
+    }
+
+    // parse delimited text
+    {
+        k13::pod_vector<k13::scalar_t> values;
+        auto result = k13::scalar_t::parse("1,2.5, -3\r\n\n4e2,5\n", ',', values);
+
+        if (!result.ok() || result.count != 5 || values.size() != 5 ||
+            !values[0].is_integer() || values[0] != 1 ||
+            !values[1].is_floating_point() || values[1] != 2.5 ||
+            !values[2].is_integer() || values[2] != -3 ||
+            !values[3].is_floating_point() || values[3] != 400.0 ||
+            values[4] != 5)
+        {
+            return -1;
+        }
+
+        // tab separated, appending
+        result = k13::scalar_t::parse("6\t7", '\t', values);
+
+        if (!result.ok() || result.count != 2 || values.size() != 7 || values[6] != 7)
+        {
+            return -1;
+        }
+
+        // errors report the offset of the first bad field, keeping the numbers before it
+        values.clear();
+        result = k13::scalar_t::parse("1,2,x,4", ',', values);
+
+        if (result.ok() || result.error != 4 || result.count != 2 || values.size() != 2)
+        {
+            return -1;
+        }
+
+        values.clear();
+        if (k13::scalar_t::parse("1,,2", ',', values).error != 2 ||
+            k13::scalar_t::parse("1,2,\n3", ',', values).error != 4 ||
+            k13::scalar_t::parse("1,2 3", ',', values).error != 2 ||
+            !k13::scalar_t::parse("", ',', values).ok())
+        {
+            return -1;
+        }
+    }
+
+    // format
+    {
+        k13::scalar_t values[] = { 0, -42, INT64_MIN, 0.1, -2.5, 1e300, 2.2250738585072014e-308, -2.2250738585072014e-308, 1.0 / 3.0 };
+
+        char buffer[k13::scalar_t::max_chars];
+
+        for (const auto& x : values)
+        {
+            // shortest form round trips, with its type
+            auto r = x.to_chars(buffer, buffer + sizeof(buffer));
+            auto y = k13::scalar_t::parse(std::string_view(buffer, static_cast<size_t>(r.ptr - buffer)));
+
+            if (r.ec != std::errc() || !y || y->is_integer() != x.is_integer() || *y != x || x.to_string() != std::string(buffer, r.ptr))
+            {
+                return -1;
+            }
+        }
+
+        if (k13::scalar_t(0.1).to_string() != "0.1" || k13::scalar_t(-42).to_string() != "-42" || k13::scalar_t(1e300).to_string() != "1e+300")
+        {
+            return -1;
+        }
+
+        // precision matches iostream setprecision
+        if (k13::scalar_t(0.1).to_string(17) != "0.10000000000000001" || k13::scalar_t(1.0 / 3.0).to_string(3) != "0.333" || k13::scalar_t(7).to_string(3) != "7")
+        {
+            return -1;
+        }
+
+        // too small a buffer
+        if (k13::scalar_t(12345).to_chars(buffer, buffer + 4).ec != std::errc::value_too_large)
+        {
+            return -1;
+        }
+
+        // append
+        k13::pod_vector<char> text;
+        text.push_back('[');
+        k13::scalar_t(1.5).append_chars(text);
+        text.push_back(']');
+
+        if (std::string(text.data(), text.size()) != "[1.5]")
+        {
+            return -1;
+        }
+
+        text.clear();
+        k13::scalar_t::append_chars(values, 3, ',', text);
+
+        if (std::string(text.data(), text.size()) != "0,-42,-9223372036854775808")
+        {
+            return -1;
+        }
+
+        // round trip through the bulk parser
+        k13::pod_vector<k13::scalar_t> parsed;
+        text.clear();
+        k13::scalar_t::append_chars(values, sizeof(values) / sizeof(values[0]), ',', text);
+
+        if (!k13::scalar_t::parse(std::string_view(text.data(), text.size()), ',', parsed).ok() || parsed.size() != sizeof(values) / sizeof(values[0]))
+        {
+            return -1;
+        }
+
+        for (size_t i = 0; i != parsed.size(); ++i)
+        {
+            if (parsed[i] != values[i] || parsed[i].is_integer() != values[i].is_integer())
+            {
+                return -1;
+            }
+        }
+    }
+
     return 0;
 }
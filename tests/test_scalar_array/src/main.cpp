@@ -0,0 +1,275 @@
+// k13
+// Kyle J Burgess
+
+#include "scalar_array.h"
+
+#include <cmath>
+#include <cstdint>
+
+// Returns n scalars, all integers, all reals, or a mix, and none of them zero
+k13::pod_vector<k13::scalar_t> make_scalars(size_t n, uint64_t seed, int kind)
+{
+    k13::pod_vector<k13::scalar_t> v(n);
+
+    uint64_t state = seed;
+    for (size_t i = 0; i != n; ++i)
+    {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+
+        auto x = static_cast<int64_t>(state >> 52u) - 2048;
+        x = (x == 0) ? 1 : x;
+
+        bool real = (kind == 1) || (kind == 2 && ((state >> 20u) & 1u));
+
+        if (real)
+        {
+            v[i] = static_cast<double>(x) * 0.25;
+        }
+        else
+        {
+            v[i] = x;
+        }
+    }
+
+    return v;
+}
+
+// True if x holds the same values and types as v
+bool equal(const k13::scalar_array& x, const k13::pod_vector<k13::scalar_t>& v)
+{
+    if (x.size() != v.size())
+    {
+        return false;
+    }
+
+    size_t real_count = 0;
+
+    for (size_t i = 0; i != v.size(); ++i)
+    {
+        if (x[i].is_floating_point() != v[i].is_floating_point() || x.is_real(i) != v[i].is_floating_point())
+        {
+            return false;
+        }
+
+        if (v[i].is_floating_point()
+            ? (static_cast<double>(x[i]) != static_cast<double>(v[i]))
+            : (static_cast<int64_t>(x[i]) != static_cast<int64_t>(v[i])))
+        {
+            return false;
+        }
+
+        real_count += v[i].is_floating_point() ? 1u : 0u;
+    }
+
+    return x.real_count() == real_count &&
+        x.all_real() == (real_count == v.size()) &&
+        x.all_integer() == (real_count == 0);
+}
+
+// Checks every operator of a and b against scalar_t
+bool test_ops(const k13::pod_vector<k13::scalar_t>& a, const k13::pod_vector<k13::scalar_t>& b)
+{
+    size_t n = a.size();
+
+    k13::scalar_array x(a.data(), n);
+    k13::scalar_array y(b.data(), n);
+
+    if (!equal(x, a) || !equal(y, b))
+    {
+        return false;
+    }
+
+    k13::pod_vector<k13::scalar_t> sum(n), difference(n), product(n), quotient(n);
+
+    for (size_t i = 0; i != n; ++i)
+    {
+        sum[i] = a[i] + b[i];
+        difference[i] = a[i] - b[i];
+        product[i] = a[i] * b[i];
+        quotient[i] = a[i] / b[i];
+    }
+
+    if (!equal(x + y, sum) || !equal(x - y, difference) || !equal(x * y, product) || !equal(x / y, quotient))
+    {
+        return false;
+    }
+
+    k13::scalar_array z = x;
+    z += y;
+    z -= y;
+    z *= y;
+    z /= y;
+
+    for (size_t i = 0; i != n; ++i)
+    {
+        if (z[i] != ((a[i] + b[i] - b[i]) * b[i]) / b[i])
+        {
+            return false;
+        }
+    }
+
+    auto eq = (x == y);
+    auto ne = (x != y);
+    auto lt = (x < y);
+    auto gt = (x > y);
+    auto le = (x <= y);
+    auto ge = (x >= y);
+    auto self = (x == x);
+
+    for (size_t i = 0; i != n; ++i)
+    {
+        if (eq[i] != (a[i] == b[i]) ||
+            ne[i] != (a[i] != b[i]) ||
+            lt[i] != (a[i] < b[i]) ||
+            gt[i] != (a[i] > b[i]) ||
+            le[i] != (a[i] <= b[i]) ||
+            ge[i] != (a[i] >= b[i]) ||
+            self[i] != 1)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main()
+{
+    // int, real and mixed columns against each other, at sizes around the tag words
+    for (size_t n : { 0u, 1u, 63u, 64u, 65u, 1000u })
+    {
+        for (int kind_a = 0; kind_a != 3; ++kind_a)
+        {
+            for (int kind_b = 0; kind_b != 3; ++kind_b)
+            {
+                auto a = make_scalars(n, 13u + n, kind_a);
+                auto b = make_scalars(n, 31u + n, kind_b);
+
+                if (!test_ops(a, b))
+                {
+                    return -1;
+                }
+            }
+        }
+    }
+
+    // integer division truncates, as with scalar_t
+    {
+        int64_t a[] = { 7, -7, 9 };
+        int64_t b[] = { 2, 2, 10 };
+
+        k13::scalar_array q = k13::scalar_array(a, 3) / k13::scalar_array(b, 3);
+
+        if (!q.all_integer() || q[0] != 3 || q[1] != -3 || q[2] != 0)
+        {
+            return -1;
+        }
+    }
+
+    // comparisons with NaN match scalar_t, where <= and >= are not > and not <
+    {
+        double a[] = { std::nan(""), 1.0, std::nan("") };
+        int64_t b[] = { 1, 2, 3 };
+
+        k13::scalar_array x(a, 3);
+        k13::scalar_array y(b, 3);
+
+        auto eq = (x == y);
+        auto ne = (x != y);
+        auto lt = (x < y);
+        auto gt = (x > y);
+        auto le = (x <= y);
+        auto ge = (x >= y);
+
+        for (size_t i = 0; i != 3; ++i)
+        {
+            k13::scalar_t sa(a[i]);
+            k13::scalar_t sb(b[i]);
+
+            if (eq[i] != (sa == sb) || ne[i] != (sa != sb) ||
+                lt[i] != (sa < sb) || gt[i] != (sa > sb) ||
+                le[i] != (sa <= sb) || ge[i] != (sa >= sb))
+            {
+                return -1;
+            }
+        }
+
+        if (le[0] != 1 || ge[0] != 1)
+        {
+            return -1;
+        }
+    }
+
+    // typed constructors
+    {
+        double a[] = { 0.5, 1.5, 2.5 };
+        k13::scalar_array x(a, 3);
+
+        if (!x.all_real() || x.real_count() != 3 || x[1] != 1.5)
+        {
+            return -1;
+        }
+
+        k13::scalar_array y(size_t(70));
+        if (!y.all_integer() || y.size() != 70 || y[69] != 0)
+        {
+            return -1;
+        }
+    }
+
+    // push_back, set, resize and clear keep the types
+    {
+        k13::scalar_array x;
+        k13::pod_vector<k13::scalar_t> v;
+
+        auto values = make_scalars(200, 7u, 2);
+
+        for (size_t i = 0; i != values.size(); ++i)
+        {
+            x.push_back(values[i]);
+            v.push_back(values[i]);
+        }
+
+        if (!equal(x, v))
+        {
+            return -1;
+        }
+
+        for (size_t i = 0; i < values.size(); i += 3)
+        {
+            k13::scalar_t s = x.is_real(i) ? k13::scalar_t(int64_t(5)) : k13::scalar_t(5.5);
+            x.set(i, s);
+            v[i] = s;
+        }
+
+        if (!equal(x, v))
+        {
+            return -1;
+        }
+
+        // shrinking drops the types of removed elements, growing adds integer zeros
+        x.resize(70);
+        v.resize(70);
+        x.resize(130);
+        v.resize(130, k13::scalar_t(int64_t(0)));
+
+        if (!equal(x, v))
+        {
+            return -1;
+        }
+
+        auto round_trip = x.to_vector();
+        if (!equal(x, round_trip))
+        {
+            return -1;
+        }
+
+        x.clear();
+        if (!x.empty() || x.real_count() != 0 || !x.all_integer() || !x.all_real())
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
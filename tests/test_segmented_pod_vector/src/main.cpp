@@ -0,0 +1,152 @@
+// k13
+// Kyle J Burgess
+
+#include "segmented_pod_vector.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+template<class T>
+bool check_equality(const k13::segmented_pod_vector<T, 4>& pv, const std::vector<T>& v)
+{
+    if (pv.size() != v.size())
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i != pv.size(); ++i)
+    {
+        if (pv[i] != v[i])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+template<class T>
+bool test()
+{
+    k13::segmented_pod_vector<T, 4> pv(40, 3);
+    std::vector<T> v(40, 3);
+
+    if (!check_equality(pv, v))
+    {
+        return false;
+    }
+
+    // addresses are stable while growing
+    const T* first = &pv[0];
+    const T* last = &pv[39];
+
+    for (size_t i = 0; i != 1000; ++i)
+    {
+        pv.push_back(static_cast<T>(i));
+        v.push_back(static_cast<T>(i));
+    }
+
+    if (!check_equality(pv, v) || first != &pv[0] || last != &pv[39])
+    {
+        return false;
+    }
+
+    // bulk push_back across chunk boundaries
+    std::vector<T> src(77);
+    for (size_t i = 0; i != src.size(); ++i)
+    {
+        src[i] = static_cast<T>(i * 2);
+    }
+
+    pv.push_back(src.data(), src.size());
+    v.insert(v.end(), src.begin(), src.end());
+
+    if (!check_equality(pv, v))
+    {
+        return false;
+    }
+
+    // per-chunk iteration
+    size_t count = 0;
+    pv.for_each_chunk([&](k13::pod_span<T> chunk)
+    {
+        if (chunk.size() > pv.chunk_size || !std::equal(chunk.begin(), chunk.end(), v.begin() + count))
+        {
+            count = ~size_t(0);
+        }
+        count += chunk.size();
+    });
+
+    if (count != v.size() || pv.chunk_count() != (v.size() + 15) / 16)
+    {
+        return false;
+    }
+
+    // iterators
+    if (!std::equal(pv.cbegin(), pv.cend(), v.begin()) || (pv.end() - pv.begin()) != static_cast<std::ptrdiff_t>(v.size()))
+    {
+        return false;
+    }
+
+    // resize
+    pv.resize(10);
+    v.resize(10);
+
+    pv.resize(100, 5);
+    v.resize(100, 5);
+
+    if (!check_equality(pv, v))
+    {
+        return false;
+    }
+
+    pv.pop_back();
+    v.pop_back();
+
+    // copy
+    auto copy = pv;
+
+    if (!check_equality(copy, v) || &copy[0] == &pv[0])
+    {
+        return false;
+    }
+
+    // shrink
+    pv.clear();
+    pv.shrink_to_fit();
+
+    if (pv.capacity() != 0 || !pv.empty())
+    {
+        return false;
+    }
+
+    pv = std::move(copy);
+
+    return check_equality(pv, v);
+}
+
+int main()
+{
+    if (!test<uint8_t>())
+    {
+        return -1;
+    }
+
+    if (!test<uint32_t>())
+    {
+        return -1;
+    }
+
+    if (!test<int64_t>())
+    {
+        return -1;
+    }
+
+    if (!test<double>())
+    {
+        return -1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,135 @@
+// k13
+// Kyle J Burgess
+
+#include "shared_pod_vector.h"
+#include "thread_pool.h"
+
+#include <cstdint>
+
+int main()
+{
+    k13::pod_vector<uint32_t> pv;
+
+    for (uint32_t i = 0; i != 1000; ++i)
+    {
+        pv.push_back(i);
+    }
+
+    const uint32_t* ptr = pv.data();
+
+    // freeze without copying
+    k13::shared_pod_vector<uint32_t> a(std::move(pv));
+
+    if (a.data() != ptr || a.size() != 1000 || !pv.empty() || !a.unique())
+    {
+        return -1;
+    }
+
+    // copies and slices share the buffer
+    auto b = a;
+    auto c = a.slice(100, 50);
+
+    if (b.data() != ptr || c.data() != ptr + 100 || c.size() != 50 || c[0] != 100 || a.unique())
+    {
+        return -1;
+    }
+
+    // slices keep the buffer alive
+    a = k13::shared_pod_vector<uint32_t>();
+    b = k13::shared_pod_vector<uint32_t>();
+
+    if (c.back() != 149 || !c.unique())
+    {
+        return -1;
+    }
+
+    // copy-on-write
+    auto d = c;
+    d.mutable_at(0) = 7;
+
+    if (c[0] != 100 || d[0] != 7 || c.data() == d.data())
+    {
+        return -1;
+    }
+
+    // unique writes do not copy
+    const uint32_t* dptr = d.data();
+    d.mutable_at(1) = 8;
+
+    if (d.data() != dptr || d[1] != 8)
+    {
+        return -1;
+    }
+
+    // spans
+    auto span = c.span();
+    uint32_t sum = 0;
+
+    for (auto x : span)
+    {
+        sum += x;
+    }
+
+    if (sum != (100 + 149) * 25)
+    {
+        return -1;
+    }
+
+    // thaw a unique full buffer without copying
+    auto e = std::move(d).thaw();
+
+    if (e.data() != dptr || e.size() != 50 || e[1] != 8 || !d.empty())
+    {
+        return -1;
+    }
+
+    // thaw a shared slice with a copy
+    auto f = c;
+    auto g = std::move(f).thaw();
+
+    if (g.data() == c.data() || g.size() != 50 || g[49] != 149)
+    {
+        return -1;
+    }
+
+    // hand off between thread_pool tasks
+    k13::thread_pool pool(4, std::chrono::milliseconds(1));
+
+    k13::pod_vector<uint64_t> pv64(4096);
+    for (size_t i = 0; i != pv64.size(); ++i)
+    {
+        pv64[i] = i;
+    }
+
+    k13::shared_pod_vector<uint64_t> shared(std::move(pv64));
+
+    k13::thread_task tasks[4];
+    uint64_t sums[4] = {};
+
+    for (size_t t = 0; t != 4; ++t)
+    {
+        pool.run(tasks[t], [slice = shared.slice(t * 1024, 1024), &sum = sums[t]]()
+        {
+            for (size_t i = 0; i != slice.size(); ++i)
+            {
+                sum += slice[i];
+            }
+        });
+    }
+
+    shared = k13::shared_pod_vector<uint64_t>();
+
+    uint64_t total = 0;
+    for (size_t t = 0; t != 4; ++t)
+    {
+        tasks[t].wait();
+        total += sums[t];
+    }
+
+    if (total != 4095ull * 4096ull / 2ull)
+    {
+        return -1;
+    }
+
+    return 0;
+}
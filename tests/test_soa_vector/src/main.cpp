@@ -0,0 +1,158 @@
+// k13
+// Kyle J Burgess
+
+#include "soa_vector.h"
+
+#include <algorithm>
+#include <cstdint>
+
+struct Record
+{
+    uint32_t id;
+    double value;
+    uint8_t flag;
+};
+
+int main()
+{
+    k13::soa_vector<uint32_t, double, uint8_t> v;
+
+    // column-wise push_back
+    for (uint32_t i = 0; i != 100; ++i)
+    {
+        v.push_back(i, i * 0.5, static_cast<uint8_t>(i % 2));
+    }
+
+    if (v.size() != 100 || v.column<1>().size() != 100)
+    {
+        return -1;
+    }
+
+    if (v.get<0>(10) != 10 || v.get<1>(10) != 5.0 || v.get<2>(11) != 1)
+    {
+        return -1;
+    }
+
+    // proxy references
+    std::get<1>(v[20]) = -1.0;
+
+    if (v.column<1>()[20] != -1.0)
+    {
+        return -1;
+    }
+
+    // iterate rows
+    uint32_t sum = 0;
+
+    for (auto it = v.begin(); it != v.end(); ++it)
+    {
+        auto [id, value, flag] = *it;
+
+        if (flag)
+        {
+            sum += id;
+        }
+    }
+
+    if (sum != 2500)
+    {
+        return -1;
+    }
+
+    if (std::distance(v.cbegin(), v.cend()) != 100 || (v.cbegin() + 5).get<0>() != 5)
+    {
+        return -1;
+    }
+
+    // random access
+    {
+        auto first = v.cbegin();
+        auto last = v.cend();
+
+        if (!(first < last) || !(first <= first) || !(last > first) || !(last >= last) ||
+            std::get<0>(first[7]) != 7 || (3 + first).get<0>() != 3)
+        {
+            return -1;
+        }
+
+        // ids are sorted, so a binary search over rows finds one by id
+        auto it = std::lower_bound(first, last, 42u, [](const auto& row, uint32_t id)
+        {
+            return std::get<0>(row) < id;
+        });
+
+        if (it - first != 42 || it.get<1>() != 21.0)
+        {
+            return -1;
+        }
+    }
+
+    // columns are aligned for simd loads
+    if (reinterpret_cast<uintptr_t>(v.column<0>().data()) % 64 != 0 ||
+        reinterpret_cast<uintptr_t>(v.column<1>().data()) % 64 != 0 ||
+        reinterpret_cast<uintptr_t>(v.column<2>().data()) % 64 != 0)
+    {
+        return -1;
+    }
+
+    // scan a single column
+    const auto& ids = v.column<0>();
+
+    if (std::count_if(ids.cbegin(), ids.cend(), [](uint32_t x) { return x >= 50; }) != 50)
+    {
+        return -1;
+    }
+
+    // bulk resize
+    v.resize(150, 7u, 1.5, static_cast<uint8_t>(3));
+
+    if (v.size() != 150 || v.get<0>(149) != 7 || v.get<1>(100) != 1.5 || v.get<2>(120) != 3 || v.get<0>(99) != 99)
+    {
+        return -1;
+    }
+
+    v.pop_back();
+    v.resize(10);
+
+    if (v.size() != 10 || v.column<2>().size() != 10)
+    {
+        return -1;
+    }
+
+    // AoS -> SoA
+    Record records[64];
+
+    for (uint32_t i = 0; i != 64; ++i)
+    {
+        records[i] = { i * 3, i * 0.25, static_cast<uint8_t>(i) };
+    }
+
+    k13::soa_vector<uint32_t, double, uint8_t> w;
+    w.push_back_aos(records, 64, &Record::id, &Record::value, &Record::flag);
+
+    if (w.size() != 64 || w.get<0>(63) != 189 || w.get<1>(4) != 1.0 || w.get<2>(17) != 17)
+    {
+        return -1;
+    }
+
+    // SoA -> AoS
+    Record out[64] = {};
+    w.copy_to_aos(out, &Record::id, &Record::value, &Record::flag);
+
+    for (size_t i = 0; i != 64; ++i)
+    {
+        if (out[i].id != records[i].id || out[i].value != records[i].value || out[i].flag != records[i].flag)
+        {
+            return -1;
+        }
+    }
+
+    w.clear();
+
+    if (!w.empty())
+    {
+        return -1;
+    }
+
+    return 0;
+}
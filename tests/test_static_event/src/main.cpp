@@ -0,0 +1,99 @@
+// k13
+// Kyle J Burgess
+
+#include "static_event.h"
+
+int total = 0;
+
+void add(int x)
+{
+    total += x;
+}
+
+k13::callback_persistence add_once(int x)
+{
+    total += 100 * x;
+    return k13::remove_callback;
+}
+
+struct Counter
+{
+    int calls = 0;
+
+    k13::callback_persistence operator()(int)
+    {
+        ++calls;
+        return (calls == 3)
+            ? k13::remove_callback
+            : k13::persist_callback;
+    }
+};
+
+struct Accumulator
+{
+    int sum = 0;
+
+    void operator()(int& x)
+    {
+        sum += x;
+        ++x;
+    }
+};
+
+int main()
+{
+    k13::static_event<k13::static_handler<&add>, k13::static_handler<&add_once>, Counter> e;
+
+    for (int i = 0; i != 5; ++i)
+    {
+        e.invoke(1);
+    }
+
+    // add five times, add_once once, Counter three times
+    if (total != 105 || e.handler<2>().calls != 3)
+    {
+        return -1;
+    }
+
+    if (!e.active<0>() || e.active<1>() || e.active<2>())
+    {
+        return -1;
+    }
+
+    e.reset();
+    e.invoke(1);
+
+    if (total != 206 || e.handler<2>().calls != 4 || e.active<1>())
+    {
+        return -1;
+    }
+
+    e.set_active<1>(true);
+    e.invoke(2);
+
+    if (total != 408)
+    {
+        return -1;
+    }
+
+    // handlers receive the same lvalue, in order
+    k13::static_event<Accumulator, Accumulator> f;
+    int x = 1;
+    f.invoke(x);
+
+    if (x != 3 || f.handler<0>().sum != 1 || f.handler<1>().sum != 2)
+    {
+        return -1;
+    }
+
+    // stateful handlers from the constructor
+    k13::static_event<Accumulator> g(Accumulator { 10 });
+    g.invoke(x);
+
+    if (g.handler<0>().sum != 13)
+    {
+        return -1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,118 @@
+// k13
+// Kyle J Burgess
+
+#include "thread_pool.h"
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+int main()
+{
+    k13::thread_pool pool(2, std::chrono::milliseconds(1));
+
+    // wait() blocks until the task has run, even if it is still queued
+    {
+        std::atomic<bool> done(false);
+        k13::thread_task task;
+
+        pool.run(task, [&]()
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            done = true;
+        });
+
+        task.wait();
+
+        if (!done || !task.is_complete())
+        {
+            return -1;
+        }
+    }
+
+    // a task that throws is reported as an error, and wait() rethrows it
+    {
+        k13::thread_task task;
+
+        pool.run(task, []()
+        {
+            throw std::runtime_error("task failed");
+        });
+
+        bool caught = false;
+        try
+        {
+            task.wait();
+        }
+        catch (const std::runtime_error&)
+        {
+            caught = true;
+        }
+
+        if (!caught)
+        {
+            return -1;
+        }
+
+        // running the task again clears the previous exception
+        std::atomic<int> calls(0);
+        pool.run(task, [&]()
+        {
+            ++calls;
+        });
+
+        task.wait();
+
+        if (calls != 1 || !task.is_complete())
+        {
+            return -1;
+        }
+    }
+
+    // many tasks, each waited on
+    {
+        constexpr size_t n = 64;
+
+        std::atomic<size_t> count(0);
+        k13::thread_task tasks[n];
+
+        for (auto& task : tasks)
+        {
+            pool.run(task, [&]()
+            {
+                ++count;
+            });
+        }
+
+        for (auto& task : tasks)
+        {
+            task.wait();
+        }
+
+        if (count != n)
+        {
+            return -1;
+        }
+    }
+
+    // a pool with no threads runs tasks immediately
+    {
+        k13::thread_pool inline_pool(0, std::chrono::milliseconds(1));
+
+        bool done = false;
+        k13::thread_task task;
+
+        inline_pool.run(task, [&]()
+        {
+            done = true;
+        });
+
+        if (!done || !task.is_complete())
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,294 @@
+// k13
+// Kyle J Burgess
+
+#include "varint.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+static_assert(k13::zigzag_encode(int32_t(0)) == 0u, "zigzag 0");
+static_assert(k13::zigzag_encode(int32_t(-1)) == 1u, "zigzag -1");
+static_assert(k13::zigzag_encode(int32_t(1)) == 2u, "zigzag 1");
+static_assert(k13::zigzag_encode(int64_t(-2)) == 3u, "zigzag -2");
+static_assert(k13::zigzag_encode(INT32_MIN) == UINT32_MAX, "zigzag min");
+static_assert(k13::zigzag_decode(k13::zigzag_encode(INT64_MIN)) == INT64_MIN, "zigzag round trip");
+static_assert(k13::varint_size(127) == 1 && k13::varint_size(128) == 2 && k13::varint_size(UINT64_MAX) == 10, "varint_size");
+
+// Deterministic values of mixed magnitude
+uint64_t next_value(uint64_t& state)
+{
+    state = state * 6364136223846793005ull + 1442695040888963407ull;
+    return state >> (state % 64u);
+}
+
+// Checks a block round trips through the bit packing kernels at bits
+bool test_bitpack_block(const uint32_t* values, uint32_t bits)
+{
+    uint8_t packed[16 * 32 + 1];
+    uint32_t unpacked[128];
+
+    uint32_t mask = (bits == 32) ? ~uint32_t(0) : ((uint32_t(1) << bits) - 1u);
+
+    memset(packed, 0xcd, sizeof(packed));
+    k13::bitpack128(values, packed, bits);
+
+    // nothing written past the block
+    if (packed[k13::bitpack_bytes(bits)] != 0xcd)
+    {
+        return false;
+    }
+
+    k13::bitunpack128(packed, unpacked, bits);
+
+    for (size_t i = 0; i != 128; ++i)
+    {
+        if (unpacked[i] != (values[i] & mask))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+template<uint32_t Bits>
+bool test_bitpack_scalar(const uint32_t* values)
+{
+    // the scalar kernels use the same layout as the vector kernels
+    uint8_t packed[16 * 32];
+    uint8_t expected[16 * 32];
+    uint32_t unpacked[128];
+    uint32_t unpacked_expected[128];
+
+    k13::impl_bitpack128_scalar<Bits>(values, packed);
+    k13::bitpack128(values, expected, Bits);
+
+    if (memcmp(packed, expected, k13::bitpack_bytes(Bits)) != 0)
+    {
+        return false;
+    }
+
+    k13::impl_bitunpack128_scalar<Bits>(packed, unpacked);
+    k13::bitunpack128(packed, unpacked_expected, Bits);
+
+    return memcmp(unpacked, unpacked_expected, sizeof(unpacked)) == 0;
+}
+
+template<uint32_t... Bits>
+bool test_bitpack_scalar_all(const uint32_t* values, std::integer_sequence<uint32_t, Bits...>)
+{
+    return (test_bitpack_scalar<Bits + 1u>(values) && ...);
+}
+
+int main()
+{
+    uint64_t state = 13;
+
+    // varint round trip
+    {
+        std::vector<uint64_t> values = { 0, 1, 127, 128, 300, 16383, 16384, UINT32_MAX, UINT64_MAX, UINT64_MAX >> 1u };
+
+        for (size_t i = 0; i != 1000; ++i)
+        {
+            values.push_back(next_value(state));
+        }
+
+        k13::pod_vector<uint8_t> buffer;
+        size_t expected_size = 0;
+
+        for (uint64_t x : values)
+        {
+            k13::varint_append(buffer, x);
+            expected_size += k13::varint_size(x);
+        }
+
+        if (buffer.size() != expected_size)
+        {
+            return -1;
+        }
+
+        // one value at a time
+        size_t position = 0;
+
+        for (uint64_t x : values)
+        {
+            uint64_t y;
+            size_t read = k13::varint_decode(buffer.data() + position, buffer.size() - position, y);
+
+            if (read != k13::varint_size(x) || y != x)
+            {
+                return -1;
+            }
+
+            position += read;
+        }
+
+        // in bulk
+        k13::pod_vector<uint8_t> bulk;
+        k13::varint_append(bulk, values.data(), values.size());
+
+        if (bulk.size() != buffer.size() || memcmp(bulk.data(), buffer.data(), bulk.size()) != 0)
+        {
+            return -1;
+        }
+
+        std::vector<uint64_t> decoded(values.size());
+        if (k13::varint_decode(bulk.data(), bulk.size(), decoded.data(), decoded.size()) != bulk.size() || decoded != values)
+        {
+            return -1;
+        }
+
+        // truncated
+        if (k13::varint_decode(bulk.data(), bulk.size() - 1u, decoded.data(), decoded.size()) != 0)
+        {
+            return -1;
+        }
+
+        // too large for the destination type
+        std::vector<uint32_t> narrow(values.size());
+        if (k13::varint_decode(bulk.data(), bulk.size(), narrow.data(), narrow.size()) != 0)
+        {
+            return -1;
+        }
+    }
+
+    // invalid varints
+    {
+        uint64_t x;
+
+        uint8_t encoded[2] = { 0xac, 0x02 };
+        if (k13::varint_decode(encoded, 2, x) != 2 || x != 300)
+        {
+            return -1;
+        }
+
+        uint8_t empty[1] = { 0 };
+        if (k13::varint_decode(empty, 0, x) != 0)
+        {
+            return -1;
+        }
+
+        uint8_t overlong[11] = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x01 };
+        if (k13::varint_decode(overlong, 11, x) != 0)
+        {
+            return -1;
+        }
+
+        uint8_t overflow[10] = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x02 };
+        if (k13::varint_decode(overflow, 10, x) != 0)
+        {
+            return -1;
+        }
+
+        // only the shortest encoding of a value is accepted
+        uint8_t padded[3] = { 0x80, 0x00, 0x00 };
+        if (k13::varint_decode(padded, 2, x) != 0 || k13::varint_decode(padded + 1, 1, x) != 1 || x != 0)
+        {
+            return -1;
+        }
+
+        uint8_t padded_300[3] = { 0xac, 0x82, 0x00 };
+        if (k13::varint_decode(padded_300, 3, x) != 0)
+        {
+            return -1;
+        }
+    }
+
+    // zigzag varints
+    {
+        k13::pod_vector<uint8_t> buffer;
+
+        for (int64_t x = -1000; x <= 1000; ++x)
+        {
+            k13::varint_append(buffer, k13::zigzag_encode(x));
+        }
+
+        size_t position = 0;
+
+        for (int64_t x = -1000; x <= 1000; ++x)
+        {
+            uint64_t y;
+            position += k13::varint_decode(buffer.data() + position, buffer.size() - position, y);
+
+            if (k13::zigzag_decode(y) != x)
+            {
+                return -1;
+            }
+        }
+
+        // the 128 values from -64 to 63 fit in one byte, the rest in two
+        if (buffer.size() != 128u + 2u * (2001u - 128u))
+        {
+            return -1;
+        }
+    }
+
+    // bit packing
+    {
+        uint32_t values[128];
+
+        for (uint32_t bits = 0; bits <= 32; ++bits)
+        {
+            for (auto& v : values)
+            {
+                v = static_cast<uint32_t>(next_value(state));
+            }
+
+            if (!test_bitpack_block(values, bits))
+            {
+                return -1;
+            }
+        }
+
+        if (!test_bitpack_scalar_all(values, std::make_integer_sequence<uint32_t, 32>()))
+        {
+            return -1;
+        }
+
+        // width
+        uint32_t small[5] = { 1, 2, 3, 0, 5 };
+        if (k13::bitpack_width(small, 5) != 3 || k13::bitpack_width(small, 0) != 0 || k13::bitpack_width(values, 128) != 32)
+        {
+            return -1;
+        }
+    }
+
+    // bit packed streams
+    for (size_t n : { 0u, 1u, 127u, 128u, 129u, 1000u, 4096u })
+    {
+        std::vector<uint32_t> values(n);
+
+        // blocks of different widths
+        for (size_t i = 0; i != n; ++i)
+        {
+            values[i] = static_cast<uint32_t>(next_value(state)) & ((1u << ((i / 128u) % 20u)) - 1u);
+        }
+
+        k13::pod_vector<uint8_t> buffer;
+        buffer.push_back(0xee);
+        k13::bitpack_append(buffer, values.data(), n);
+
+        std::vector<uint32_t> decoded(n);
+        size_t read = k13::bitpack_decode(buffer.data() + 1, buffer.size() - 1u, decoded.data(), n);
+
+        if (read != buffer.size() - 1u || decoded != values)
+        {
+            return -1;
+        }
+
+        // a small-valued stream is much smaller than its values
+        if (n == 4096 && buffer.size() > n * sizeof(uint32_t) / 2u)
+        {
+            return -1;
+        }
+
+        // truncated
+        if (n != 0 && k13::bitpack_decode(buffer.data() + 1, buffer.size() - 2u, decoded.data(), n) != 0)
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}